@@ -1,83 +1,92 @@
-#include <algorithm>
+#include <cstring>
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
-#include <array>
-#include <cmath>
 #include <vector>
-#include <fast-io.hpp>
 
-constexpr size_t BUFFER_SIZE = 16*1024;
-constexpr size_t INITIAL_INSTRUCTION_CAPACITY = 8096;
-constexpr bool DEBUG_FAST_IO = true;
-constexpr int DIAL_START_POSITION = 50;
-
-inline int floor_div_100(int value){
-    return (value > 0) ? value / 100 : (value - 99) / 100;
-}
+#include "batch-runner.hpp"
+#include "instrument.hpp"
+#include "solution.hpp"
 
-size_t count_zeros_passed(int dial_position, int instruction) {
-    if (instruction > 0) {
-        return floor_div_100(dial_position + instruction) - floor_div_100(dial_position);
-    } else if (instruction < 0) {
-        return floor_div_100(dial_position - 1) - floor_div_100(dial_position + instruction - 1);
-    }
-    return 0;
-}
+constexpr bool DEBUG_FAST_IO = true;
 
 
 int main(int argc, char* argv[]){
     const char* path = nullptr;
+    std::vector<std::string> inputs;
+    day1::SolveMode mode = day1::SolveMode::Scan;
+    const char* profile_path = nullptr;  // --profile FILE: per-phase JSON report, "-" for stdout
+    bool batch_mode = false;  // --batch: every argument is a file, directory or @manifest
+    batch::Options batch_options;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--sequential") == 0) {
+            mode = day1::SolveMode::Sequential;
+        } else if (std::strcmp(argv[i], "--check") == 0) {
+            mode = day1::SolveMode::Check;
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--counters") == 0) {
+            if (!instrument::Profiler::instance().enable_counters()) {
+                std::cerr << "Hardware counters unavailable, timing only" << std::endl;
+            }
+        } else if (std::strcmp(argv[i], "--batch") == 0) {
+            batch_mode = true;
+        } else if (batch::parse_option(argc, argv, i, batch_options)) {
+            continue;
+        } else {
+            path = argv[i];
+            inputs.push_back(argv[i]);
+        }
+    }
+
+    if (batch_mode) {
+        std::vector<std::string> files;
+        if (!batch::collect_inputs(inputs, files)) return 1;
+        const int status = batch::run(files, {"zeros", "wraps"}, [&](const char* file) {
+            return batch::solve_file<day1::Input>(
+                file, day1::parse,
+                [&](const day1::Input& input) { return day1::solve(input, mode); },
+                [](const day1::Answer& answer) { return std::vector<std::string>{std::to_string(answer.zeros_stops), std::to_string(answer.zeros_passed)}; });
+        }, batch_options);
+        if (profile_path != nullptr && !instrument::write_report(profile_path, "day_1", "batch")) {
+            std::cerr << "Can't write profile: " << profile_path << std::endl;
+            return 1;
+        }
+        return status;
+    }
 
-    if (argc < 2) {
+    if (path == nullptr) {
         std::cout << "Using default data file: ./data.txt" << std::endl;
         path = "./data.txt";
     } else {
-        std::cout << "Using supplied data file: " << argv[1] << std::endl;
-        path = argv[1];
+        std::cout << "Using supplied data file: " << path << std::endl;
     }
 
-    size_t zeros_stops = 0; //part 1
-    size_t zeros_passed = 0; //part 2
-    int dial_position = DIAL_START_POSITION;
-
-    auto stats = fast_io::read_lines(
-        path,
-        [&](const char* line, size_t len) {
-            if (len < 2) return;
-
-            int instruction = fast_io::parse_int(line + 1, len - 1);
-
-            int multiplier = 0;
-            if (line[0] == 'R') {
-                multiplier = 1;
-            } else if (line[0] == 'L') {
-                multiplier = -1;
-            }
-            else {
-                return;
-            }
-
-            instruction *= multiplier;
-
-            zeros_passed += count_zeros_passed(dial_position, instruction); //solution part 2.
-
-            int total = dial_position + instruction;
-            dial_position = ((total % 100) + 100) % 100; // wrap to 0-99
-
-            if (dial_position == 0)
-                zeros_stops++; //solution for part 1
-        },
-        DEBUG_FAST_IO);
+    day1::Input input;
+    auto stats = day1::parse(path, input, DEBUG_FAST_IO);
 
     if (!stats) {
         std::cerr << "Can't open file: " << path << std::endl;
         return 1;
     }
 
-    std::cout << "zeros: " << zeros_stops << std::endl;
-    std::cout << "wraps: " << zeros_passed << std::endl;
+    const day1::Answer answer = day1::solve(input, mode);
+
+    if (mode == day1::SolveMode::Check) {
+        const day1::Answer reference = day1::solve_sequential(input);
+        if (reference.zeros_stops != answer.zeros_stops || reference.zeros_passed != answer.zeros_passed) {
+            std::cerr << "Mismatch: scan " << answer.zeros_stops << "/" << answer.zeros_passed
+                      << " vs sequential " << reference.zeros_stops << "/" << reference.zeros_passed << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "zeros: " << answer.zeros_stops << std::endl;
+    std::cout << "wraps: " << answer.zeros_passed << std::endl;
 
+    if (profile_path != nullptr && !instrument::write_report(profile_path, "day_1", path)) {
+        std::cerr << "Can't write profile: " << profile_path << std::endl;
+        return 1;
+    }
     return 0;
 }
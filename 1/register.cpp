@@ -0,0 +1,15 @@
+#include <string>
+#include <vector>
+
+#include "solution.hpp"
+#include "solver-registry.hpp"
+
+// Day 1 entry for the aoc driver.
+namespace {
+    const registry::Registration DAY1{{1, {"zeros", "wraps"}, [](const char* path) {
+        return batch::solve_file<day1::Input>(
+            path, day1::parse,
+            [](const day1::Input& input) { return day1::solve(input); },
+            [](const day1::Answer& answer) { return std::vector<std::string>{std::to_string(answer.zeros_stops), std::to_string(answer.zeros_passed)}; });
+    }}};
+}
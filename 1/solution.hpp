@@ -0,0 +1,235 @@
+#ifndef DAY1_SOLUTION_HPP
+#define DAY1_SOLUTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "fast-io.hpp"
+#include "instrument.hpp"
+#include "thread-pool.hpp"
+
+namespace day1 {
+
+    constexpr int DIAL_START_POSITION = 50;
+    constexpr int DIAL_SIZE = 100;
+
+    // Zeros the dial passes (landing on zero included) while turning from dial_position (0-99) by instruction clicks.
+    // Turning left from p passes as many zeros as turning right from the mirrored position (100 - p) mod 100, so both
+    // directions share one branch-free formula. Works on the unsigned magnitude, so any int64_t rotation is fine.
+    inline uint64_t count_zeros_passed(int dial_position, int64_t instruction) {
+        const uint64_t clicks = instruction < 0 ? uint64_t{0} - static_cast<uint64_t>(instruction)
+                                                : static_cast<uint64_t>(instruction);
+        const int mirrored = dial_position == 0 ? 0 : DIAL_SIZE - dial_position;
+        const uint64_t start = static_cast<uint64_t>(instruction < 0 ? mirrored : dial_position);
+        return clicks / DIAL_SIZE + (clicks % DIAL_SIZE + start) / DIAL_SIZE;
+    }
+
+    // Clockwise offset of an instruction on the dial, 0-99.
+    inline uint8_t dial_offset(int64_t instruction) {
+        const int64_t offset = instruction % DIAL_SIZE;
+        return static_cast<uint8_t>(offset < 0 ? offset + DIAL_SIZE : offset);
+    }
+
+    struct Input {
+        std::vector<int64_t> instructions;  // signed rotation: R is positive, L is negative
+    };
+
+    enum class SolveMode {
+        Scan,        // positions as a parallel prefix sum mod 100, then every instruction on its own
+        Sequential,  // carry the dial from one instruction to the next
+        Check,       // Scan; main compares against Sequential
+    };
+
+    struct Answer {
+        size_t zeros_stops = 0;   //part 1
+        size_t zeros_passed = 0;  //part 2
+    };
+
+    // Instructions of the lines in range go to out, other lines are skipped. Returns the number written.
+    inline size_t parse_instructions(const fast_io::LineIndex& index, fast_io::LineRange range, int64_t* out) {
+        size_t written = 0;
+        index.for_each_line(range, [&](const char* line, size_t len) {
+            fast_io::format<"{c}{i64}">.apply(line, len, [&](char direction, int64_t clicks) {
+                if (direction == 'R') {
+                    out[written++] = clicks;
+                } else if (direction == 'L') {
+                    out[written++] = -clicks;
+                }
+            });
+        });
+        return written;
+    }
+
+    // One instruction per line, so the line index sizes the vector exactly; every thread parses an equal share of the
+    // lines straight into its slice.
+    inline std::optional<fast_io::ReadStats> parse(const char* path, Input& input, bool debug = false) {
+        INSTRUMENT_SCOPE("parse");
+        return fast_io::read_indexed(
+            path,
+            [&](const fast_io::LineIndex& index) {
+                auto& instructions = input.instructions;
+                instructions.resize(index.size());
+                const auto ranges = index.split(index.thread_count());
+                std::vector<size_t> written(ranges.size(), 0);
+                fast_io::parallel_for_lines(ranges, [&](size_t part, fast_io::LineRange range) {
+                    written[part] = parse_instructions(index, range, instructions.data() + range.first);
+                });
+
+                // close the gaps left by skipped lines, in file order
+                size_t size = 0;
+                for (size_t part = 0; part < ranges.size(); part++) {
+                    const auto slice = instructions.begin() + static_cast<ptrdiff_t>(ranges[part].first);
+                    if (ranges[part].first != size) std::move(slice, slice + written[part], instructions.begin() + size);
+                    size += written[part];
+                }
+                instructions.resize(size);
+            },
+            {}, debug);
+    }
+
+    inline Answer solve_sequential(const Input& input) {
+        Answer answer;
+        int dial_position = DIAL_START_POSITION;
+
+        for (const int64_t instruction : input.instructions) {
+            answer.zeros_passed += count_zeros_passed(dial_position, instruction); //solution part 2.
+
+            dial_position = (dial_position + dial_offset(instruction)) % DIAL_SIZE; // wrap to 0-99
+
+            if (dial_position == 0)
+                answer.zeros_stops++; //solution for part 1
+        }
+        return answer;
+    }
+
+    namespace Scan {
+
+        constexpr size_t MIN_BLOCK_SIZE = 64 * 1024;  // instructions per thread, below this a thread does not pay off
+
+        // positions[i] = (start + offsets[0] + ... + offsets[i]) mod 100; returns the last position.
+        inline uint8_t prefix_positions_scalar(const uint8_t* offsets, uint8_t* positions, size_t count, uint8_t start) {
+            uint8_t position = start;
+            for (size_t i = 0; i < count; i++) {
+                position = static_cast<uint8_t>(position + offsets[i]);
+                if (position >= DIAL_SIZE) position -= DIAL_SIZE;
+                positions[i] = position;
+            }
+            return position;
+        }
+
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+        // (a + b) mod 100 for bytes already below 100: the sum is below 200, so it is either s or s - 100, and the
+        // unsigned minimum picks the right one (s - 100 wraps around when s < 100).
+        FAST_IO_TARGET("sse2")
+        inline __m128i add_mod_dial(__m128i a, __m128i b) {
+            const __m128i sum = _mm_add_epi8(a, b);
+            return _mm_min_epu8(sum, _mm_sub_epi8(sum, _mm_set1_epi8(DIAL_SIZE)));
+        }
+
+        // In-register inclusive scan of 16 offsets (shift-and-add in four steps), then the carried position is added.
+        FAST_IO_TARGET("sse2")
+        inline uint8_t prefix_positions_sse2(const uint8_t* offsets, uint8_t* positions, size_t count, uint8_t start) {
+            size_t i = 0;
+            uint8_t position = start;
+            for (; i + 16 <= count; i += 16) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(offsets + i));
+                x = add_mod_dial(x, _mm_slli_si128(x, 1));
+                x = add_mod_dial(x, _mm_slli_si128(x, 2));
+                x = add_mod_dial(x, _mm_slli_si128(x, 4));
+                x = add_mod_dial(x, _mm_slli_si128(x, 8));
+                x = add_mod_dial(x, _mm_set1_epi8(static_cast<char>(position)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(positions + i), x);
+                position = positions[i + 15];
+            }
+            return prefix_positions_scalar(offsets + i, positions + i, count - i, position);
+        }
+#endif
+
+        inline uint8_t prefix_positions(const uint8_t* offsets, uint8_t* positions, size_t count, uint8_t start) {
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+            if (fast_io::simd_level() >= fast_io::SimdLevel::SSE2) {
+                return prefix_positions_sse2(offsets, positions, count, start);
+            }
+#endif
+            return prefix_positions_scalar(offsets, positions, count, start);
+        }
+
+        // Run body(block) for every block on the shared work-stealing pool.
+        template<typename Body>
+        void for_each_block(size_t block_count, Body&& body) {
+            threading::parallel_for(0, block_count, 1, [&](size_t first, size_t last) {
+                for (size_t b = first; b < last; b++) body(b);
+            });
+        }
+    }
+
+    // Dial positions are prefix sums of the instructions mod 100, so the fold splits into three passes:
+    //  1. per block: offsets mod 100 into a byte array and their sum (parallel)
+    //  2. the block sums give every block's start position (serial, one step per block)
+    //  3. per block: SIMD prefix sum into positions, then stops and passes per instruction (parallel)
+    inline Answer solve_scan(const Input& input, size_t thread_count = 0) {
+        const std::vector<int64_t>& instructions = input.instructions;
+        const size_t count = instructions.size();
+        if (count == 0) return {};
+
+        if (thread_count == 0) thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+        const size_t block_count = std::clamp<size_t>(count / Scan::MIN_BLOCK_SIZE, 1, thread_count);
+        const size_t block_size = (count + block_count - 1) / block_count;
+
+        std::vector<uint8_t> offsets(count);
+        std::vector<uint8_t> positions(count);
+        std::vector<uint8_t> block_start(block_count, 0);
+        std::vector<Answer> block_answers(block_count);
+
+        Scan::for_each_block(block_count, [&](size_t b) {
+            const size_t first = b * block_size;
+            const size_t last = std::min(count, first + block_size);
+            unsigned int sum = 0;
+            for (size_t i = first; i < last; i++) {
+                offsets[i] = dial_offset(instructions[i]);
+                sum += offsets[i];
+            }
+            block_start[b] = static_cast<uint8_t>(sum % DIAL_SIZE);  // block's own shift until pass 2
+        });
+
+        uint8_t position = DIAL_START_POSITION;
+        for (size_t b = 0; b < block_count; b++) {
+            const uint8_t shift = block_start[b];
+            block_start[b] = position;
+            position = static_cast<uint8_t>((position + shift) % DIAL_SIZE);
+        }
+
+        Scan::for_each_block(block_count, [&](size_t b) {
+            const size_t first = b * block_size;
+            const size_t last = std::min(count, first + block_size);
+            Scan::prefix_positions(offsets.data() + first, positions.data() + first, last - first, block_start[b]);
+
+            Answer& answer = block_answers[b];
+            answer.zeros_stops = std::count(positions.begin() + first, positions.begin() + last, 0); //solution for part 1
+            uint8_t before = block_start[b];
+            for (size_t i = first; i < last; i++) {
+                answer.zeros_passed += count_zeros_passed(before, instructions[i]); //solution part 2.
+                before = positions[i];
+            }
+        });
+
+        Answer answer;
+        for (const Answer& block : block_answers) {
+            answer.zeros_stops += block.zeros_stops;
+            answer.zeros_passed += block.zeros_passed;
+        }
+        return answer;
+    }
+
+    inline Answer solve(const Input& input, SolveMode mode = SolveMode::Scan) {
+        INSTRUMENT_SCOPE("solve");
+        if (mode == SolveMode::Sequential) return solve_sequential(input);
+        return solve_scan(input);
+    }
+}
+
+#endif
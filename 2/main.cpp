@@ -1,124 +1,107 @@
+#include <cstring>
 #include <iostream>
-#include <stdint.h>
-#include "fast-io.hpp"
+#include <string>
+#include <vector>
 
-constexpr bool DEBUG_FAST_IO = true;
-
-struct IntRange {
-    uint64_t first;
-    uint64_t last;
-
-    struct Iterator {
-        uint64_t value;
-        int64_t step;
-
-        uint64_t  operator*() const { return value; }
-        Iterator& operator++() { value += step; return *this; }
-        bool operator!=(const Iterator& other) const { return value != other.value; }
-    };
-
-    [[nodiscard]] Iterator begin() const { return {first, first <= last ? 1 : -1}; }
-    [[nodiscard]] Iterator end() const { return {first <= last ? last + 1 : last - 1, 0}; }
-
-    [[nodiscard]] size_t size() const { return last - first + 1; }
-};
+#include "batch-runner.hpp"
+#include "instrument.hpp"
+#include "solution.hpp"
 
-inline bool is_valid_id(uint64_t id) {
-    uint64_t temp = id;
-    uint64_t digits = 0;
-    while (temp > 0) {
-        ++digits;
-        temp /= 10;
-    }
-
-    // Try each possible pattern length
-    for (uint64_t pattern_len = 1; pattern_len <= digits / 2; ++pattern_len) {
-        if (digits % pattern_len != 0)
-            continue;
-
-        uint64_t repetitions = digits / pattern_len;
-        if (repetitions < 2)
-            continue;
-
-        // Divisor to extract pattern-sized chunks
-        uint64_t divisor = 1;
-        for (uint64_t i = 0; i < pattern_len; ++i)
-            divisor *= 10;
-
-        // Extract the rightmost pattern
-        const uint64_t pattern = id % divisor;
+constexpr bool DEBUG_FAST_IO = true;
 
-        // Check if all chunks match
-        uint64_t remaining = id;
-        bool all_match = true;
-        for (uint64_t r = 0; r < repetitions; ++r) {
-            if ((remaining % divisor) != pattern) {
-                all_match = false;
-                break;
+int main(int argc, char* argv[]) {
+    const char* path = nullptr;
+    std::vector<std::string> inputs;
+    day2::SolveMode mode = day2::SolveMode::ClosedForm;
+    bool print_invalid = false;  // --print-invalid: list the ids brute force found, single file --brute-force/--check
+    const char* profile_path = nullptr;  // --profile FILE: per-phase JSON report, "-" for stdout
+    bool batch_mode = false;  // --batch: every argument is a file, directory or @manifest
+    batch::Options batch_options;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--brute-force") == 0) {
+            mode = day2::SolveMode::BruteForce;
+        } else if (std::strcmp(argv[i], "--print-invalid") == 0) {
+            print_invalid = true;
+        } else if (std::strcmp(argv[i], "--check") == 0) {
+            mode = day2::SolveMode::Check;
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--counters") == 0) {
+            if (!instrument::Profiler::instance().enable_counters()) {
+                std::cerr << "Hardware counters unavailable, timing only" << std::endl;
             }
-            remaining /= divisor;
+        } else if (std::strcmp(argv[i], "--batch") == 0) {
+            batch_mode = true;
+        } else if (batch::parse_option(argc, argv, i, batch_options)) {
+            continue;
+        } else {
+            path = argv[i];
+            inputs.push_back(argv[i]);
         }
-
-        if (all_match)
-            return false;
     }
 
-    return true;
-}
-
-inline IntRange parse_range(const char* start, size_t len) {
-    constexpr char delimiter = '-';
-    uint64_t first = 0;
-    uint64_t second = 0;
-    size_t i = 0;
-
-    while (i < len && start[i] != delimiter) {
-        first = first * 10 + (start[i] - '0');
-        ++i;
+    // only brute force collects the ids
+    if (print_invalid && (batch_mode || mode == day2::SolveMode::ClosedForm)) {
+        std::cerr << "--print-invalid needs --brute-force or --check on a single file" << std::endl;
+        return 1;
     }
 
-    ++i; // skip delimiter
-
-    while (i < len) {
-        second = second * 10 + (start[i] - '0');
-        ++i;
+    if (batch_mode) {
+        std::vector<std::string> files;
+        if (!batch::collect_inputs(inputs, files)) return 1;
+        const int status = batch::run(files, {"invalid_ids"}, [&](const char* file) {
+            return batch::solve_file<day2::Input>(
+                file, day2::parse,
+                [&](const day2::Input& input) { return day2::solve(input, mode); },
+                [](const day2::Answer& answer) { return std::vector<std::string>{std::to_string(answer.invalid_ids)}; },
+                [&](const day2::Input&, const day2::Answer& answer) {
+                    if (mode != day2::SolveMode::Check || answer.invalid_ids == answer.invalid_ids_brute_force) return std::string();
+                    return "mismatch: closed form " + std::to_string(answer.invalid_ids) + " vs brute force "
+                           + std::to_string(answer.invalid_ids_brute_force);
+                });
+        }, batch_options);
+        if (profile_path != nullptr && !instrument::write_report(profile_path, "day_2", "batch")) {
+            std::cerr << "Can't write profile: " << profile_path << std::endl;
+            return 1;
+        }
+        return status;
     }
 
-    return {first, second};
-}
-
-int main(int argc, char* argv[]) {
-    const char* path = nullptr;
-
-    if (argc < 2) {
+    if (path == nullptr) {
         std::cout << "Using default data file: ./data.txt" << std::endl;
         path = "./data.txt";
     } else {
-        std::cout << "Using supplied data file: " << argv[1] << std::endl;
-        path = argv[1];
+        std::cout << "Using supplied data file: " << path << std::endl;
     }
 
-
-    uint64_t invalid_ids = 0;
-    const auto stats = fast_io::read_csv(
-        path,
-        [&](const char* line, const size_t len) {
-            for (const IntRange int_range = parse_range(line, len); const uint64_t i : int_range) {
-                if (!is_valid_id(i)) {
-                    std::cout << "invalid index: " << i << " from range: " << int_range.first << "-" << int_range.last << std::endl;
-                    invalid_ids += i;
-                }
-
-            }
-        },
-        DEBUG_FAST_IO);
+    day2::Input input;
+    const auto stats = day2::parse(path, input, DEBUG_FAST_IO);
 
     if (!stats) {
         std::cerr << "Can't open file: " << path << std::endl;
         return 1;
     }
 
-    std::cout << invalid_ids << std::endl;
+    const day2::Answer answer = day2::solve(input, mode);
+
+    if (print_invalid) {
+        for (const auto& invalid : answer.invalid_found) {
+            std::cout << "invalid index: " << invalid.id << " from range: " << invalid.range.first << "-"
+                      << invalid.range.last << std::endl;
+        }
+    }
+
+    if (mode == day2::SolveMode::Check && answer.invalid_ids != answer.invalid_ids_brute_force) {
+        std::cerr << "Mismatch: closed form " << answer.invalid_ids << " vs brute force " << answer.invalid_ids_brute_force << std::endl;
+        return 1;
+    }
+
+    std::cout << answer.invalid_ids << std::endl;
 
+    if (profile_path != nullptr && !instrument::write_report(profile_path, "day_2", path)) {
+        std::cerr << "Can't write profile: " << profile_path << std::endl;
+        return 1;
+    }
     return 0;
 }
@@ -0,0 +1,15 @@
+#include <string>
+#include <vector>
+
+#include "solution.hpp"
+#include "solver-registry.hpp"
+
+// Day 2 entry for the aoc driver.
+namespace {
+    const registry::Registration DAY2{{2, {"invalid_ids"}, [](const char* path) {
+        return batch::solve_file<day2::Input>(
+            path, day2::parse,
+            [](const day2::Input& input) { return day2::solve(input); },
+            [](const day2::Answer& answer) { return std::vector<std::string>{std::to_string(answer.invalid_ids)}; });
+    }}};
+}
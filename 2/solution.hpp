@@ -0,0 +1,256 @@
+#ifndef DAY2_SOLUTION_HPP
+#define DAY2_SOLUTION_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "fast-io.hpp"
+#include "instrument.hpp"
+#include "thread-pool.hpp"
+
+namespace day2 {
+
+    enum class SolveMode {
+        ClosedForm,  // default: arithmetic over pattern ranges, cost independent of range width
+        BruteForce,  // test every id with is_valid_id
+        Check,       // run both and compare
+    };
+
+    struct IntRange {
+        uint64_t first;
+        uint64_t last;
+
+        struct Iterator {
+            uint64_t value;
+            int64_t step;
+
+            uint64_t  operator*() const { return value; }
+            Iterator& operator++() { value += step; return *this; }
+            bool operator!=(const Iterator& other) const { return value != other.value; }
+        };
+
+        [[nodiscard]] Iterator begin() const { return {first, first <= last ? 1 : -1}; }
+        [[nodiscard]] Iterator end() const { return {first <= last ? last + 1 : last - 1, 0}; }
+
+        [[nodiscard]] size_t size() const { return last - first + 1; }
+    };
+
+    inline bool is_valid_id(uint64_t id) {
+        uint64_t temp = id;
+        uint64_t digits = 0;
+        while (temp > 0) {
+            ++digits;
+            temp /= 10;
+        }
+
+        // Try each possible pattern length
+        for (uint64_t pattern_len = 1; pattern_len <= digits / 2; ++pattern_len) {
+            if (digits % pattern_len != 0)
+                continue;
+
+            uint64_t repetitions = digits / pattern_len;
+            if (repetitions < 2)
+                continue;
+
+            // Divisor to extract pattern-sized chunks
+            uint64_t divisor = 1;
+            for (uint64_t i = 0; i < pattern_len; ++i)
+                divisor *= 10;
+
+            // Extract the rightmost pattern
+            const uint64_t pattern = id % divisor;
+
+            // Check if all chunks match
+            uint64_t remaining = id;
+            bool all_match = true;
+            for (uint64_t r = 0; r < repetitions; ++r) {
+                if ((remaining % divisor) != pattern) {
+                    all_match = false;
+                    break;
+                }
+                remaining /= divisor;
+            }
+
+            if (all_match)
+                return false;
+        }
+
+        return true;
+    }
+
+    inline std::optional<IntRange> parse_range(const char* start, size_t len) {
+        const auto range = fast_io::format<"{u64}-{u64}">.parse(start, len);
+        if (!range) return std::nullopt;
+        return IntRange{std::get<0>(*range), std::get<1>(*range)};
+    }
+
+    // Closed form solver.
+    // A D-digit id built from a p-digit pattern repeated D/p times is pattern * R(D, p), with the repunit-like
+    // R(D, p) = 1 + 10^p + 10^2p + ... + 10^(D-p). For fixed D and p those ids form an arithmetic series in the
+    // pattern, so the ones inside [first, last] can be summed directly.
+    using uint128 = unsigned __int128;
+
+    constexpr int MAX_ID_DIGITS = 20;  // uint64_t max has 20 digits
+
+    constexpr uint128 pow10_u128(int exponent) {
+        uint128 value = 1;
+        for (int i = 0; i < exponent; ++i) value *= 10;
+        return value;
+    }
+
+    // Moebius function, for the inclusion-exclusion over pattern lengths.
+    constexpr int mobius(int n) {
+        int result = 1;
+        for (int factor = 2; factor * factor <= n; ++factor) {
+            if (n % factor != 0) continue;
+            n /= factor;
+            if (n % factor == 0) return 0;
+            result = -result;
+        }
+        return n > 1 ? -result : result;
+    }
+
+    // Sum of the D-digit ids in [low, high] that repeat a pattern of pattern_len digits. Range must lie within D digits.
+    inline uint128 sum_repeated_pattern(uint64_t low, uint64_t high, int digits, int pattern_len) {
+        const uint128 repunit = (pow10_u128(digits) - 1) / (pow10_u128(pattern_len) - 1);
+        const uint128 min_pattern = std::max(pow10_u128(pattern_len - 1), (low + repunit - 1) / repunit);
+        const uint128 max_pattern = std::min(pow10_u128(pattern_len) - 1, high / repunit);
+        if (min_pattern > max_pattern) return 0;
+
+        const uint128 count = max_pattern - min_pattern + 1;
+        const uint128 pattern_sum = (min_pattern + max_pattern) * count / 2;
+        return pattern_sum * repunit;
+    }
+
+    // An id with pattern length p also repeats with every multiple of p that divides D, so summing S_p over all
+    // proper divisors would count ids several times. Weighting S_p by -mu(D/p) counts each invalid id exactly once.
+    inline uint64_t sum_invalid_ids(const IntRange& range) {
+        const uint64_t first = std::min(range.first, range.last);
+        const uint64_t last = std::max(range.first, range.last);
+
+        uint128 total = 0;
+        for (int digits = 2; digits <= MAX_ID_DIGITS; ++digits) {
+            const uint128 digits_min = pow10_u128(digits - 1);
+            const uint128 digits_max = pow10_u128(digits) - 1;
+            if (digits_min > last) break;
+            if (digits_max < first) continue;
+
+            const uint64_t low = static_cast<uint64_t>(std::max<uint128>(first, digits_min));
+            const uint64_t high = static_cast<uint64_t>(std::min<uint128>(last, digits_max));
+
+            uint128 added = 0;
+            uint128 removed = 0;
+            for (int pattern_len = 1; pattern_len < digits; ++pattern_len) {
+                if (digits % pattern_len != 0) continue;
+                const int weight = -mobius(digits / pattern_len);
+                if (weight == 0) continue;
+
+                const uint128 sum = sum_repeated_pattern(low, high, digits, pattern_len);
+                if (weight > 0) added += sum;
+                else removed += sum;
+            }
+            total += added - removed;
+        }
+        return static_cast<uint64_t>(total);
+    }
+
+    constexpr size_t BRUTE_FORCE_GRAIN = 16 * 1024;  // ids per stealing pool task
+
+    // Ids in the range, either direction.
+    inline uint64_t id_count(const IntRange& range) {
+        return (range.first <= range.last ? range.last - range.first : range.first - range.last) + 1;
+    }
+
+    struct InvalidId {
+        uint64_t id;
+        IntRange range;  // the input range it was found in
+    };
+
+    // Tests every id of every range with is_valid_id. Range widths differ by orders of magnitude, so the loop runs over
+    // the ids of all ranges laid end to end and is split by id count on the work-stealing pool, not by range.
+    // The invalid ids go to invalid in input order; nothing is printed, so this is safe on batch threads.
+    inline uint64_t sum_invalid_ids_brute_force(const std::vector<IntRange>& ranges, std::vector<InvalidId>& invalid) {
+        std::vector<uint64_t> ends;  // ends[r] = ids in ranges 0..r
+        ends.reserve(ranges.size());
+        uint64_t total_ids = 0;
+        for (const IntRange& range : ranges) ends.push_back(total_ids += id_count(range));
+
+        struct Found {
+            uint64_t position;  // among the ids of all ranges
+            size_t range;
+            uint64_t id;
+        };
+        std::mutex found_mutex;
+        std::vector<Found> found;
+
+        const auto test_ids = [&](size_t begin, size_t end) {
+            std::vector<Found> local;
+            uint64_t sum = 0;
+            size_t r = static_cast<size_t>(std::upper_bound(ends.begin(), ends.end(), begin) - ends.begin());
+            for (uint64_t position = begin; position < end; ++r) {
+                const IntRange& range = ranges[r];
+                const uint64_t range_start = r == 0 ? 0 : ends[r - 1];
+                const uint64_t stop = std::min<uint64_t>(end, ends[r]);
+                for (; position < stop; ++position) {
+                    const uint64_t offset = position - range_start;
+                    const uint64_t id = range.first <= range.last ? range.first + offset : range.first - offset;
+                    if (!is_valid_id(id)) {
+                        local.push_back({position, r, id});
+                        sum += id;
+                    }
+                }
+            }
+            if (!local.empty()) {
+                std::lock_guard lock(found_mutex);
+                found.insert(found.end(), local.begin(), local.end());
+            }
+            return sum;
+        };
+        const uint64_t invalid_ids = threading::parallel_reduce(0, total_ids, BRUTE_FORCE_GRAIN, test_ids);
+
+        std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.position < b.position; });
+        invalid.reserve(invalid.size() + found.size());
+        for (const Found& entry : found) invalid.push_back({entry.id, ranges[entry.range]});
+        return invalid_ids;
+    }
+
+    struct Input {
+        std::vector<IntRange> ranges;
+    };
+
+    struct Answer {
+        uint64_t invalid_ids = 0;
+        uint64_t invalid_ids_brute_force = 0;  // only filled in BruteForce and Check mode
+        std::vector<InvalidId> invalid_found;  // same, in input order
+    };
+
+    inline std::optional<fast_io::ReadStats> parse(const char* path, Input& input, bool debug = false) {
+        INSTRUMENT_SCOPE("parse");
+        return fast_io::read_csv(
+            path,
+            [&](const char* line, const size_t len) {
+                if (const auto range = parse_range(line, len)) input.ranges.push_back(*range);
+            },
+            debug);
+    }
+
+    inline Answer solve(const Input& input, SolveMode mode = SolveMode::ClosedForm) {
+        INSTRUMENT_SCOPE("solve");
+        Answer answer;
+        if (mode != SolveMode::BruteForce) {
+            for (const IntRange& int_range : input.ranges) answer.invalid_ids += sum_invalid_ids(int_range);
+        }
+        if (mode != SolveMode::ClosedForm) {
+            answer.invalid_ids_brute_force = sum_invalid_ids_brute_force(input.ranges, answer.invalid_found);
+        }
+        if (mode == SolveMode::BruteForce) {
+            answer.invalid_ids = answer.invalid_ids_brute_force;
+        }
+        return answer;
+    }
+}
+
+#endif
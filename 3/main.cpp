@@ -1,107 +1,142 @@
-#include <array>
-#include <vector>
-#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
-#include "fast-io.hpp"
-#define SAMPLE_INPUT;
-constexpr bool DEBUG_FAST_IO = true;
-
-namespace Escalator {
-    //Bank size based on the line length in the input data, as they are all equal in length but differ between sample and actual input
-#ifndef SAMPLE_INPUT
-#define BANK_SIZE 100
-#else
-#define BANK_SIZE 15
-#endif
-
-    struct Bank {
-
-    private:
-        struct Battery {
-            uint8_t value = 0;
-            uint8_t index = 0;
-        };
-
-        std::array<Battery, BANK_SIZE> batteries {0};
-        uint8_t battery_count = 0;
-    public:
-        [[nodiscard]] uint64_t get_max_joltage(const size_t active_battery_count) const {
-            const auto find_highest_digit = [&](const uint8_t start_position, const uint8_t end_position) -> Battery {
-                Battery best{0, start_position};
-                for (uint8_t i = start_position; i <= end_position; i++) {
-                    if (batteries[i].value > best.value) {
-                        best.value = batteries[i].value;
-                        best.index = i;
-                    }
-                }
-                return best;
-            };
+#include "batch-runner.hpp"
+#include "instrument.hpp"
+#include "solution.hpp"
 
-            uint64_t joltage = 0;
-            uint8_t search_from = 0;
+constexpr bool DEBUG_FAST_IO = true;
 
-            for (size_t i = 0; i < active_battery_count; i++) {
-                // Leave room for remaining digits after this one
-                uint8_t remaining_digits = active_battery_count - i - 1;
-                uint8_t search_until = battery_count - 1 - remaining_digits;
 
-                Battery found = find_highest_digit(search_from, search_until);
-                joltage = joltage * 10 + found.value;
-                search_from = found.index + 1;
+int main(int argc, char* argv[]) {
+    const char* path = nullptr;
+    std::vector<std::string> inputs;
+    day3::SolveMode mode = day3::SolveMode::Batch;
+    std::vector<size_t> extra_ks;  // --k N: also print the total for N active batteries
+    bool print_banks = false;
+    const char* profile_path = nullptr;  // --profile FILE: per-phase JSON report, "-" for stdout
+    bool batch_mode = false;  // --batch: every argument is a file, directory or @manifest
+    batch::Options batch_options;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--batch-greedy") == 0) {
+            mode = day3::SolveMode::Batch;
+        } else if (std::strcmp(argv[i], "--scan") == 0) {
+            mode = day3::SolveMode::Scan;
+        } else if (std::strcmp(argv[i], "--positions") == 0) {
+            mode = day3::SolveMode::Positions;
+        } else if (std::strcmp(argv[i], "--print-banks") == 0) {
+            print_banks = true;
+        } else if (std::strcmp(argv[i], "--check") == 0) {
+            mode = day3::SolveMode::Check;
+        } else if (std::strcmp(argv[i], "--k") == 0 && i + 1 < argc) {
+            // k digits per bank: the total overflows Joltage once banks * 10^k passes 2^128, e.g. k > 32 for a
+            // million banks. Checked against the bank count after parsing, see Escalator::max_total_digits.
+            const size_t k = std::strtoull(argv[++i], nullptr, 10);
+            if (k == 0 || k > day3::Escalator::MAX_JOLTAGE_DIGITS) {
+                std::cerr << "k must be between 1 and " << day3::Escalator::MAX_JOLTAGE_DIGITS << std::endl;
+                return 1;
             }
-
-            return joltage;
-        }
-
-        void print() const {
-            for (uint8_t i = 0; i < battery_count; i++) {
-                std::cout << static_cast<int>(batteries[i].value);
+            extra_ks.push_back(k);
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--counters") == 0) {
+            if (!instrument::Profiler::instance().enable_counters()) {
+                std::cerr << "Hardware counters unavailable, timing only" << std::endl;
             }
-            std::cout << std::endl;
+        } else if (std::strcmp(argv[i], "--batch") == 0) {
+            batch_mode = true;
+        } else if (batch::parse_option(argc, argv, i, batch_options)) {
+            continue;
+        } else {
+            path = argv[i];
+            inputs.push_back(argv[i]);
         }
+    }
 
-        bool add_battery(uint8_t joltage) {
-            if (battery_count >= BANK_SIZE) {return false;}
-            batteries[battery_count] = {joltage, battery_count};
-            ++battery_count;
-            return true;
+    if (batch_mode) {
+        std::vector<std::string> files;
+        if (!batch::collect_inputs(inputs, files)) return 1;
+        const int status = batch::run(files, {"joltage_one", "joltage_two"}, [&](const char* file) {
+            return batch::solve_file<day3::Input>(
+                file, day3::parse,
+                [&](const day3::Input& input) { return day3::solve(input, mode); },
+                [](const day3::Answer& answer) { return std::vector<std::string>{std::to_string(answer.joltage_one), std::to_string(answer.joltage_two)}; });
+        }, batch_options);
+        if (profile_path != nullptr && !instrument::write_report(profile_path, "day_3", "batch")) {
+            std::cerr << "Can't write profile: " << profile_path << std::endl;
+            return 1;
         }
-    };
-}
-
-
-
-
-int main(int argc, char* argv[]) {
-    const char* path = nullptr;
+        return status;
+    }
 
-    if (argc < 2) {
+    if (path == nullptr) {
         std::cout << "Using default data file: ./data.txt" << std::endl;
         path = "./data.txt";
     } else {
-        std::cout << "Using supplied data file: " << argv[1] << std::endl;
-        path = argv[1];
+        std::cout << "Using supplied data file: " << path << std::endl;
     }
-    uint64_t joltage_one = 0;
-    uint64_t joltage_two = 0;
-    auto stats = fast_io::read_lines(path, [&](const char* line, size_t len) {
-        Escalator::Bank bank;
-        if (len < 2) return;
-        for (size_t i = 0 ; i < len; i++) {
-            bank.add_battery(line[i] - '0'); //damn ascii numbers! fix.
-        }
-        bank.print();
-        joltage_one += bank.get_max_joltage(2);
-        joltage_two += bank.get_max_joltage(12);
-    },DEBUG_FAST_IO);
+    day3::Input input;
+    auto stats = day3::parse(path, input, DEBUG_FAST_IO);
 
     if (!stats) {
         std::cerr << "Can't open file: " << path << std::endl;
         return 1;
     }
 
-    std::cout << joltage_one << std::endl;
-    std::cout << joltage_two << std::endl;
+    const size_t max_k = day3::Escalator::max_total_digits(input.banks.size());
+    for (const size_t k : extra_ks) {
+        if (k > max_k) {
+            std::cerr << "k=" << k << " can overflow the total over " << input.banks.size() << " banks, at most k="
+                      << max_k << std::endl;
+            return 1;
+        }
+    }
+
+    if (print_banks) {
+        for (size_t i = 0; i < input.banks.size(); ++i) {
+            input.banks[i].print();
+        }
+    }
+
+    const day3::Answer answer = day3::solve(input, mode);
+
+    if (mode == day3::SolveMode::Check) {
+        std::vector<size_t> ks{2, 12, 19};  // 19 digits: the widest k the batch folds in uint64_t lanes
+        ks.insert(ks.end(), extra_ks.begin(), extra_ks.end());
+        const auto reference = day3::total_joltages(input, ks, day3::SolveMode::Positions);
+        const std::pair<const char*, day3::SolveMode> candidates[] {
+            {"batch", day3::SolveMode::Batch},
+            {"scan", day3::SolveMode::Scan},
+        };
+        for (const auto& [name, candidate_mode] : candidates) {
+            const auto candidate = day3::total_joltages(input, ks, candidate_mode);
+            for (size_t s = 0; s < ks.size(); ++s) {
+                if (candidate[s] != reference[s]) {
+                    std::cerr << "Mismatch: k=" << ks[s] << " " << name << " " << day3::Escalator::to_string(candidate[s])
+                              << " vs positions " << day3::Escalator::to_string(reference[s]) << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    std::cout << answer.joltage_one << std::endl;
+    std::cout << answer.joltage_two << std::endl;
+
+    if (!extra_ks.empty()) {
+        const auto totals = day3::total_joltages(input, extra_ks, mode);
+        for (size_t s = 0; s < extra_ks.size(); ++s) {
+            std::cout << "k=" << extra_ks[s] << ": " << day3::Escalator::to_string(totals[s]) << std::endl;
+        }
+    }
+
+    if (profile_path != nullptr && !instrument::write_report(profile_path, "day_3", path)) {
+        std::cerr << "Can't write profile: " << profile_path << std::endl;
+        return 1;
+    }
     return 0;
 }
@@ -0,0 +1,15 @@
+#include <string>
+#include <vector>
+
+#include "solution.hpp"
+#include "solver-registry.hpp"
+
+// Day 3 entry for the aoc driver.
+namespace {
+    const registry::Registration DAY3{{3, {"joltage_one", "joltage_two"}, [](const char* path) {
+        return batch::solve_file<day3::Input>(
+            path, day3::parse,
+            [](const day3::Input& input) { return day3::solve(input); },
+            [](const day3::Answer& answer) { return std::vector<std::string>{std::to_string(answer.joltage_one), std::to_string(answer.joltage_two)}; });
+    }}};
+}
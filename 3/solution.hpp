@@ -0,0 +1,400 @@
+#ifndef DAY3_SOLUTION_HPP
+#define DAY3_SOLUTION_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "fast-io.hpp"
+#include "instrument.hpp"
+#include "thread-pool.hpp"
+
+namespace day3 {
+
+    namespace Escalator {
+
+        using Joltage = unsigned __int128;  // a uint64_t holds 19 digits, this holds 38
+
+        constexpr size_t MAX_JOLTAGE_DIGITS = 38;
+
+        // Largest k whose total over bank_count banks always fits a Joltage: every bank may give 10^k - 1.
+        inline size_t max_total_digits(size_t bank_count) {
+            const Joltage max_total = ~Joltage{0};
+            Joltage max_joltage = 9;
+            size_t k = 0;
+            while (k < MAX_JOLTAGE_DIGITS && max_joltage <= max_total / std::max<size_t>(bank_count, 1)) {
+                k++;
+                if (k < MAX_JOLTAGE_DIGITS) max_joltage = max_joltage * 10 + 9;
+            }
+            return k;
+        }
+
+        inline std::string to_string(Joltage value) {
+            std::string digits;
+            do {
+                digits.push_back(static_cast<char>('0' + static_cast<int>(value % 10)));
+                value /= 10;
+            } while (value > 0);
+            return {digits.rbegin(), digits.rend()};
+        }
+
+        // A bank is a view into Banks storage; its width is whatever the input line was.
+        struct Bank {
+            const uint8_t* batteries = nullptr;
+            size_t battery_count = 0;
+
+            void print() const {
+                for (size_t i = 0; i < battery_count; i++) {
+                    std::cout << static_cast<int>(batteries[i]);
+                }
+                std::cout << std::endl;
+            }
+        };
+
+        // Every bank's batteries back to back, with the start of each bank.
+        struct Banks {
+            std::vector<uint8_t> batteries;
+            std::vector<size_t> starts{0};  // bank i is [starts[i], starts[i + 1])
+
+            [[nodiscard]] size_t size() const { return starts.size() - 1; }
+
+            [[nodiscard]] Bank operator[](size_t i) const {
+                return {batteries.data() + starts[i], starts[i + 1] - starts[i]};
+            }
+
+            void append(const Banks& other) {
+                const size_t offset = batteries.size();
+                batteries.insert(batteries.end(), other.batteries.begin(), other.batteries.end());
+                for (size_t i = 1; i < other.starts.size(); i++) starts.push_back(offset + other.starts[i]);
+            }
+        };
+
+        // Original greedy: for each of the k digits rescan the window that still leaves room for the rest. O(k * n).
+        inline Joltage max_joltage_scan(const Bank& bank, size_t active_battery_count) {
+            if (active_battery_count > bank.battery_count || active_battery_count > MAX_JOLTAGE_DIGITS) return 0;
+
+            Joltage joltage = 0;
+            size_t search_from = 0;
+            for (size_t i = 0; i < active_battery_count; i++) {
+                // Leave room for remaining digits after this one
+                const size_t remaining_digits = active_battery_count - i - 1;
+                const size_t search_until = bank.battery_count - 1 - remaining_digits;
+
+                size_t best = search_from;
+                for (size_t j = search_from + 1; j <= search_until; j++) {
+                    if (bank.batteries[j] > bank.batteries[best]) best = j;
+                }
+                joltage = joltage * 10 + bank.batteries[best];
+                search_from = best + 1;
+            }
+            return joltage;
+        }
+
+        // Positions of each digit in a bank as bitmasks, built in one pass over the line.
+        class DigitPositions {
+        public:
+            void build(const Bank& bank) {
+                words_ = (bank.battery_count + 63) / 64;
+                masks_.assign(words_ * 10, 0);
+                for (size_t i = 0; i < bank.battery_count; i++) {
+                    masks_[bank.batteries[i] * words_ + i / 64] |= uint64_t{1} << (i % 64);
+                }
+            }
+
+            // First position >= from holding digit, or SIZE_MAX.
+            [[nodiscard]] size_t next(uint8_t digit, size_t from) const {
+                const uint64_t* mask = masks_.data() + digit * words_;
+                size_t word = from / 64;
+                if (word >= words_) return SIZE_MAX;
+                uint64_t bits = mask[word] & (~uint64_t{0} << (from % 64));
+                while (bits == 0) {
+                    if (++word == words_) return SIZE_MAX;
+                    bits = mask[word];
+                }
+                return word * 64 + std::countr_zero(bits);
+            }
+
+        private:
+            std::vector<uint64_t> masks_;  // digit-major, words_ per digit
+            size_t words_ = 0;
+        };
+
+        // Same greedy as max_joltage_scan, but "largest digit in the window" becomes: the highest digit whose next
+        // position is still inside the window. That is a few bit scans per output digit instead of a window rescan,
+        // and the position masks are shared by every k. Banks shorter than k, and k above MAX_JOLTAGE_DIGITS, give 0.
+        inline void max_joltages(const Bank& bank, std::span<const size_t> ks, std::span<Joltage> joltages) {
+            thread_local DigitPositions positions;
+            positions.build(bank);
+
+            const size_t n = bank.battery_count;
+            for (size_t s = 0; s < ks.size(); s++) {
+                const size_t k = ks[s];
+                if (k > n || k > MAX_JOLTAGE_DIGITS) {
+                    joltages[s] = 0;
+                    continue;
+                }
+
+                // A uint64_t is enough up to 19 digits and keeps the common case off 128-bit multiplies.
+                uint64_t low = 0;
+                Joltage joltage = 0;
+                size_t search_from = 0;
+                for (size_t i = 0; i < k; i++) {
+                    const size_t search_until = n - (k - i);  // leave room for remaining digits after this one
+                    uint8_t digit = 9;
+                    size_t found = positions.next(digit, search_from);
+                    while (found > search_until) found = positions.next(--digit, search_from);
+
+                    if (k <= 19) low = low * 10 + digit;
+                    else joltage = joltage * 10 + digit;
+                    search_from = found + 1;
+                }
+                joltages[s] = k <= 19 ? Joltage{low} : joltage;
+            }
+        }
+
+        // Structure-of-arrays batch: BATCH_LANES banks of the same width, transposed so position p of every bank is one
+        // contiguous row and the greedy can run on all lanes at once. Positions are bytes, so only banks up to
+        // MAX_BATCH_WIDTH wide are batched.
+        constexpr size_t BATCH_LANES = 32;
+        constexpr size_t MAX_BATCH_WIDTH = 255;
+
+        struct BankBatch {
+            std::vector<uint8_t> digits;  // digits[p * BATCH_LANES + lane]
+            size_t width = 0;
+            size_t lanes = 0;             // banks in use; unused lanes are zero and ignored
+
+            void load(const Banks& banks, size_t first, size_t count) {
+                width = banks[first].battery_count;
+                lanes = count;
+                digits.assign(width * BATCH_LANES, 0);
+                for (size_t lane = 0; lane < count; lane++) {
+                    const uint8_t* batteries = banks[first + lane].batteries;
+                    for (size_t p = 0; p < width; p++) digits[p * BATCH_LANES + lane] = batteries[p];
+                }
+            }
+        };
+
+        // Picks the k digits of every lane into chosen[i * BATCH_LANES + lane]. k <= width. Plain greedy, one lane at a
+        // time; the reference for the SIMD kernel.
+        inline void batch_greedy_generic(const BankBatch& batch, size_t k, uint8_t* chosen) {
+            const size_t n = batch.width;
+            for (size_t lane = 0; lane < BATCH_LANES; lane++) {
+                size_t search_from = 0;
+                for (size_t i = 0; i < k; i++) {
+                    const size_t search_until = n - (k - i);  // leave room for remaining digits after this one
+                    size_t best = search_from;
+                    for (size_t p = search_from + 1; p <= search_until && batch.digits[best * BATCH_LANES + lane] < 9; p++) {
+                        if (batch.digits[p * BATCH_LANES + lane] > batch.digits[best * BATCH_LANES + lane]) best = p;
+                    }
+                    chosen[i * BATCH_LANES + lane] = batch.digits[best * BATCH_LANES + lane];
+                    search_from = best + 1;
+                }
+            }
+        }
+
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+        // All 32 lanes per instruction. Per output digit, walk the rows of the window once: positions a lane has already
+        // used are masked to 0, a strictly greater digit takes over best and its position. Once every lane holds a 9
+        // the rest of the window cannot change anything.
+        FAST_IO_TARGET("avx2")
+        inline void batch_greedy_avx2(const BankBatch& batch, size_t k, uint8_t* chosen) {
+            static_assert(BATCH_LANES == 32);
+            const size_t n = batch.width;
+            const __m256i nines = _mm256_set1_epi8(9);
+            const __m256i one = _mm256_set1_epi8(1);
+            __m256i from = _mm256_setzero_si256();  // first position each lane may still use
+
+            for (size_t i = 0; i < k; i++) {
+                // a window of zeros keeps the first usable position, as the scalar greedy does
+                __m256i best = _mm256_setzero_si256();
+                __m256i best_position = from;
+                const size_t search_until = n - (k - i);
+
+                // from >= i in every lane, since every earlier digit used at least one position.
+                for (size_t p = i; p <= search_until; p++) {
+                    const __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.digits.data() + p * BATCH_LANES));
+                    const __m256i position = _mm256_set1_epi8(static_cast<char>(p));
+                    const __m256i usable = _mm256_cmpeq_epi8(_mm256_max_epu8(position, from), position);  // p >= from
+                    const __m256i digit = _mm256_and_si256(row, usable);
+                    const __m256i better = _mm256_cmpgt_epi8(digit, best);  // digits are 0-9, signed compare is fine
+                    best = _mm256_max_epu8(best, digit);
+                    best_position = _mm256_blendv_epi8(best_position, position, better);
+                    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(best, nines)) == -1) break;
+                }
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(chosen + i * BATCH_LANES), best);
+                from = _mm256_add_epi8(best_position, one);
+            }
+        }
+#endif
+
+        inline void batch_greedy(const BankBatch& batch, size_t k, uint8_t* chosen) {
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+            if (fast_io::simd_level() >= fast_io::SimdLevel::AVX2) {
+                batch_greedy_avx2(batch, k, chosen);
+                return;
+            }
+#endif
+            batch_greedy_generic(batch, k, chosen);
+        }
+
+        // Adds the best joltage of every lane to totals[s], for every k = ks[s].
+        inline void batch_total_joltages(const BankBatch& batch, std::span<const size_t> ks, std::span<Joltage> totals) {
+            alignas(32) uint8_t chosen[MAX_JOLTAGE_DIGITS * BATCH_LANES];
+            for (size_t s = 0; s < ks.size(); s++) {
+                const size_t k = ks[s];
+                if (k > batch.width || k > MAX_JOLTAGE_DIGITS) continue;
+
+                batch_greedy(batch, k, chosen);
+
+                // Digit rows fold into per-lane values; the uint64_t case vectorizes across lanes. 32 lanes of up
+                // to 19 digits overflow a uint64_t, so they are summed as Joltage.
+                if (k <= 19) {
+                    uint64_t joltages[BATCH_LANES] = {};
+                    for (size_t i = 0; i < k; i++) {
+                        for (size_t lane = 0; lane < BATCH_LANES; lane++) {
+                            joltages[lane] = joltages[lane] * 10 + chosen[i * BATCH_LANES + lane];
+                        }
+                    }
+                    Joltage sum = 0;
+                    for (size_t lane = 0; lane < batch.lanes; lane++) sum += joltages[lane];
+                    totals[s] += sum;
+                } else {
+                    for (size_t lane = 0; lane < batch.lanes; lane++) {
+                        Joltage joltage = 0;
+                        for (size_t i = 0; i < k; i++) joltage = joltage * 10 + chosen[i * BATCH_LANES + lane];
+                        totals[s] += joltage;
+                    }
+                }
+            }
+        }
+
+        // Per-chunk line parser for fast_io::read_lines_parallel; chunks are concatenated in file order.
+        struct BankParser {
+            Banks banks;
+
+            void operator()(const char* line, size_t len) {
+                if (len < 2) return;
+                const size_t start = banks.batteries.size();
+                banks.batteries.resize(start + len);
+                uint8_t* out = banks.batteries.data() + start;
+                uint8_t invalid = 0;
+                for (size_t i = 0 ; i < len; i++) {
+                    out[i] = static_cast<uint8_t>(line[i] - '0'); //damn ascii numbers! fix.
+                    invalid |= out[i] > 9;
+                }
+                if (invalid) {
+                    //skip anything that is not a digit
+                    banks.batteries.resize(std::remove_if(out, out + len, [](uint8_t joltage) { return joltage > 9; })
+                                           - banks.batteries.data());
+                }
+                if (banks.batteries.size() > start) banks.starts.push_back(banks.batteries.size());
+            }
+        };
+    }
+
+    struct Input {
+        Escalator::Banks banks;
+    };
+
+    enum class SolveMode {
+        Batch,      // equal-width runs of banks transposed and searched BATCH_LANES at a time
+        Positions,  // digit position masks built once per bank, shared by all k
+        Scan,       // rescan the window per digit and per k
+        Check,      // Batch; main compares Batch and Scan against Positions
+    };
+
+    struct Answer {
+        uint64_t joltage_one = 0;
+        uint64_t joltage_two = 0;
+    };
+
+    inline std::optional<fast_io::ReadStats> parse(const char* path, Input& input, bool debug = false) {
+        INSTRUMENT_SCOPE("parse");
+        return fast_io::read_lines_parallel(
+            path,
+            [](size_t) { return Escalator::BankParser{}; },
+            [&](Escalator::BankParser&& chunk) {
+                input.banks.append(chunk.banks);
+            },
+            {}, debug);
+    }
+
+    constexpr size_t BANK_GRAIN = 32;  // batches of BATCH_LANES banks per stealing pool task
+
+    // Adds the best joltage of every bank in [first, last) to totals, for each k.
+    inline void add_joltages(const Escalator::Banks& banks, size_t first, size_t last, std::span<const size_t> ks,
+                             SolveMode mode, std::span<Escalator::Joltage> totals) {
+        std::vector<Escalator::Joltage> best(ks.size(), 0);
+        const bool batched = mode == SolveMode::Batch || mode == SolveMode::Check;
+        thread_local Escalator::BankBatch batch;
+
+        size_t i = first;
+        while (i < last) {
+            // runs of equal-width banks, at most one batch long
+            const size_t width = banks[i].battery_count;
+            size_t count = 1;
+            while (count < Escalator::BATCH_LANES && i + count < last && banks[i + count].battery_count == width) {
+                ++count;
+            }
+
+            if (batched && count == Escalator::BATCH_LANES && width <= Escalator::MAX_BATCH_WIDTH) {
+                batch.load(banks, i, count);
+                Escalator::batch_total_joltages(batch, ks, totals);
+                i += count;
+                continue;
+            }
+
+            // partial runs, banks too wide to batch, and the per-bank modes
+            for (const size_t end = i + count; i < end; i++) {
+                const Escalator::Bank bank = banks[i];
+                if (mode == SolveMode::Scan) {
+                    for (size_t s = 0; s < ks.size(); s++) best[s] = Escalator::max_joltage_scan(bank, ks[s]);
+                } else {
+                    Escalator::max_joltages(bank, ks, best);
+                }
+                for (size_t s = 0; s < ks.size(); s++) totals[s] += best[s];
+            }
+        }
+    }
+
+    // Sum over all banks of the best joltage with k active batteries, for each k.
+    // Banks are handed to the work-stealing pool in whole batches, so every task batches exactly as one thread would.
+    inline std::vector<Escalator::Joltage> total_joltages(const Input& input, std::span<const size_t> ks,
+                                                          SolveMode mode = SolveMode::Batch) {
+        std::vector<Escalator::Joltage> totals(ks.size(), 0);
+        const Escalator::Banks& banks = input.banks;
+        const size_t batch_count = (banks.size() + Escalator::BATCH_LANES - 1) / Escalator::BATCH_LANES;
+
+        std::mutex totals_mutex;
+        threading::parallel_for(0, batch_count, BANK_GRAIN, [&](size_t begin, size_t end) {
+            std::vector<Escalator::Joltage> part(ks.size(), 0);
+            add_joltages(banks, begin * Escalator::BATCH_LANES, std::min(end * Escalator::BATCH_LANES, banks.size()),
+                         ks, mode, part);
+            std::lock_guard lock(totals_mutex);
+            for (size_t s = 0; s < ks.size(); s++) totals[s] += part[s];
+        });
+        return totals;
+    }
+
+    inline Answer solve(const Input& input, SolveMode mode = SolveMode::Batch) {
+        INSTRUMENT_SCOPE("solve");
+        constexpr std::array<size_t, 2> ks{2, 12};
+        const auto totals = total_joltages(input, ks, mode);
+
+        Answer answer;
+        answer.joltage_one = static_cast<uint64_t>(totals[0]);
+        answer.joltage_two = static_cast<uint64_t>(totals[1]);
+        return answer;
+    }
+}
+
+#endif
@@ -1,148 +1,121 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
 
-#include <array>
-#include <bitset>
-#include <cstdint>
-#include <functional>
-
-#include "fast-io.hpp"
+#include "batch-runner.hpp"
+#include "instrument.hpp"
+#include "solution.hpp"
 
 constexpr bool DEBUG_FAST_IO = true;
-constexpr size_t EXPECTED_MAX_GRID_SIZE = 8096;
-
-namespace Grid {
-
-    struct GridDef {
-        int width = 0;
-        int height = 0;
-    };
-
-    struct GridCoord {
-        int x = 0;
-        int y = 0;
-    };
-
-    using GridIndex = int;
 
-    GridIndex coord_to_index(const GridDef& def, const GridCoord& coord) {
-        return coord.x + def.width * coord.y;
-    }
-
-    GridCoord index_to_coord(const GridDef& def, GridIndex index) {
-        return {index % static_cast<int>(def.width), index / static_cast<int>(def.width)};
-    }
-
-    inline bool is_valid(const GridDef& def, const GridCoord& coord) {
-        return coord.x >= 0 && coord.x < def.width && coord.y >= 0 && coord.y < def.height;
-    }
 
-    inline bool is_valid(const GridDef& def, const GridIndex index) {
-        return index >= 0 && index < (def.width * def.height);
-    }
-
-    template<typename Func>
-    void for_each_neighbor(const GridDef& def, const GridCoord& coord, Func&& func) {
-        constexpr GridCoord offsets[8] {
-            {-1,0},
-            {-1,1},
-            {0, 1},
-            {1, 1},
-            {1, 0},
-            {1,-1},
-            {0,-1},
-            {-1,-1}
-        };
-        for (auto offset : offsets) {
-            GridCoord neighbor_coord{.x = coord.x + offset.x, .y = coord.y + offset.y};
-            if (is_valid(def, neighbor_coord)) {
-                func(coord_to_index(def, neighbor_coord));
+int main(int argc, char* argv[]) {
+    const char* path = nullptr;
+    std::vector<std::string> inputs;
+    day4::SolveMode mode = day4::SolveMode::BitPacked;
+    bool print_waves = false;
+    const char* profile_path = nullptr;  // --profile FILE: per-phase JSON report, "-" for stdout
+    bool batch_mode = false;  // --batch: every argument is a file, directory or @manifest
+    batch::Options batch_options;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--naive") == 0) {
+            mode = day4::SolveMode::Naive;
+        } else if (std::strcmp(argv[i], "--worklist") == 0) {
+            mode = day4::SolveMode::Worklist;
+        } else if (std::strcmp(argv[i], "--tiled") == 0) {
+            mode = day4::SolveMode::Tiled;
+        } else if (std::strcmp(argv[i], "--waves") == 0) {
+            print_waves = true;
+        } else if (std::strcmp(argv[i], "--check") == 0) {
+            mode = day4::SolveMode::Check;
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--counters") == 0) {
+            if (!instrument::Profiler::instance().enable_counters()) {
+                std::cerr << "Hardware counters unavailable, timing only" << std::endl;
             }
+        } else if (std::strcmp(argv[i], "--batch") == 0) {
+            batch_mode = true;
+        } else if (batch::parse_option(argc, argv, i, batch_options)) {
+            continue;
+        } else {
+            path = argv[i];
+            inputs.push_back(argv[i]);
         }
     }
 
-    void for_each_neighbor(const GridDef& def, const GridIndex index, std::function<void(const GridIndex)>&& func) {
-        if (is_valid(def, index)) {
-            GridCoord neighbor_coord = index_to_coord(def, index);
-            for_each_neighbor(def, neighbor_coord, std::move(func));
+    if (batch_mode) {
+        std::vector<std::string> files;
+        if (!batch::collect_inputs(inputs, files)) return 1;
+        const int status = batch::run(files, {"movable", "removed"}, [&](const char* file) {
+            return batch::solve_file<day4::Input>(
+                file, day4::parse,
+                [&](const day4::Input& input) { return day4::solve(input, mode); },
+                [](const day4::Answer& answer) { return std::vector<std::string>{std::to_string(answer.movable_count), std::to_string(answer.removed_count)}; });
+        }, batch_options);
+        if (profile_path != nullptr && !instrument::write_report(profile_path, "day_4", "batch")) {
+            std::cerr << "Can't write profile: " << profile_path << std::endl;
+            return 1;
         }
+        return status;
     }
-}
-
-
-
 
-
-int main(int argc, char* argv[]) {
-    const char* path = nullptr;
-
-    if (argc < 2) {
+    if (path == nullptr) {
         std::cout << "Using default data file: ./data.txt" << std::endl;
         path = "./data.txt";
     } else {
-        std::cout << "Using supplied data file: " << argv[1] << std::endl;
-        path = argv[1];
+        std::cout << "Using supplied data file: " << path << std::endl;
     }
 
-    std::vector<bool> grid;
-    grid.reserve(EXPECTED_MAX_GRID_SIZE); // should be enough.
-    Grid::GridDef def;
-    auto stats = fast_io::read_lines(
-        path,
-        [&](const char* line, size_t len) {
-            if (def.width == 0) {
-                def.width = static_cast<unsigned int>(len);
-            }
-            def.height++;
-            for (size_t i = 0; i < len; i++) {
-                grid.push_back(line[i] == '@');
-            }
-        },
-        DEBUG_FAST_IO);
+    day4::Input input;
+    auto stats = day4::parse(path, input, DEBUG_FAST_IO);
 
     if (!stats) {
         std::cerr << "Can't open file: " << path << std::endl;
         return 1;
     }
 
-    unsigned int movable_count = 0;
-    for (size_t i = 0; i < grid.size(); i++) {
-        if (!grid[i])
-            continue; //count only for cells with a roll in it.
+    const auto solve_start = std::chrono::steady_clock::now();
+    const day4::Answer answer = day4::solve(input, mode);
+    const auto solve_end = std::chrono::steady_clock::now();
 
-        uint8_t neighbor_count = 0;
-        Grid::for_each_neighbor(def,static_cast<Grid::GridIndex>(i),[&](const Grid::GridIndex index) {
-            if (grid[index] == true)
-                neighbor_count++;
-        });
-        if (neighbor_count < 4)
-            movable_count++;
+    if (mode == day4::SolveMode::Check) {
+        const day4::Answer reference = day4::solve_naive(input);
+        const std::pair<const char*, day4::Answer> candidates[] {
+            {"bit-packed", answer},
+            {"worklist", day4::solve_worklist(input)},
+            {"tiled", day4::solve_tiled(input)},
+        };
+        for (const auto& [name, candidate] : candidates) {
+            if (reference.movable_count != candidate.movable_count || reference.removed_count != candidate.removed_count) {
+                std::cerr << "Mismatch: " << name << " " << candidate.movable_count << "/" << candidate.removed_count
+                          << " vs naive " << reference.movable_count << "/" << reference.removed_count << std::endl;
+                return 1;
+            }
+        }
     }
 
-    std::cout << movable_count << std::endl; //Part 1.
-
-    unsigned int removed_count = movable_count;
-    movable_count = 0;
-
-    while (removed_count > 0) {
-        removed_count = 0;
-        for (size_t i = 0; i < grid.size(); i++) {
-            if (!grid[i])
-                continue;
-
-            uint8_t neighbor_count = 0;
-            Grid::for_each_neighbor(def, static_cast<Grid::GridIndex>(i), [&](const Grid::GridIndex index) {
-                if (grid[index] == true)
-                    neighbor_count++;
-            });
-
-            if (neighbor_count < 4) {
-                removed_count++;
-                grid[i] = false; //remove the roll.
-            }
+    if (print_waves) {
+        for (size_t wave = 0; wave < answer.wave_removals.size(); ++wave) {
+            std::cout << "wave " << wave + 1 << ": " << answer.wave_removals[wave] << std::endl;
         }
-        movable_count += removed_count;
     }
 
-    std::cout << movable_count << std::endl; //Part 2
+    if (mode == day4::SolveMode::Tiled) {
+        const double solve_seconds = std::chrono::duration<double>(solve_end - solve_start).count();
+        std::cout << "cells evaluated: " << answer.cells_evaluated << " ("
+                  << static_cast<double>(answer.cells_evaluated) / solve_seconds / 1e6 << " Mcells/s)" << std::endl;
+    }
 
+    std::cout << answer.movable_count << std::endl; //Part 1.
+    std::cout << answer.removed_count << std::endl; //Part 2
+
+    if (profile_path != nullptr && !instrument::write_report(profile_path, "day_4", path)) {
+        std::cerr << "Can't write profile: " << profile_path << std::endl;
+        return 1;
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,15 @@
+#include <string>
+#include <vector>
+
+#include "solution.hpp"
+#include "solver-registry.hpp"
+
+// Day 4 entry for the aoc driver.
+namespace {
+    const registry::Registration DAY4{{4, {"movable", "removed"}, [](const char* path) {
+        return batch::solve_file<day4::Input>(
+            path, day4::parse,
+            [](const day4::Input& input) { return day4::solve(input); },
+            [](const day4::Answer& answer) { return std::vector<std::string>{std::to_string(answer.movable_count), std::to_string(answer.removed_count)}; });
+    }}};
+}
@@ -0,0 +1,477 @@
+#ifndef DAY4_SOLUTION_HPP
+#define DAY4_SOLUTION_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "fast-io.hpp"
+#include "grid.hpp"
+#include "instrument.hpp"
+#include "thread-pool.hpp"
+
+namespace day4 {
+
+    namespace PaperRolls {
+
+        using grid::GridDef;
+
+        // One bit per cell, 64 cells per word. Each row has a zero guard word on both sides and the grid has a zero
+        // guard row above and below, so neighbor words can be read without bounds checks.
+        struct PackedGrid {
+            GridDef def;
+            size_t stride = 0;  // words per row, guards included
+            std::vector<uint64_t> words;
+
+            static size_t stride_for(int width) {
+                return (static_cast<size_t>(width) + 63) / 64 + 2;
+            }
+
+            [[nodiscard]] size_t word_count() const { return stride - 2; }
+            [[nodiscard]] const uint64_t* row(int y) const { return words.data() + (y + 1) * stride; }
+            [[nodiscard]] uint64_t* row(int y) { return words.data() + (y + 1) * stride; }
+
+            [[nodiscard]] bool get(int x, int y) const {
+                return (row(y)[1 + x / 64] >> (x % 64)) & 1;
+            }
+
+            [[nodiscard]] size_t count() const {
+                size_t total = 0;
+                for (const uint64_t word : words) total += std::popcount(word);
+                return total;
+            }
+
+            [[nodiscard]] std::vector<bool> to_cells() const {
+                std::vector<bool> cells;
+                cells.reserve(static_cast<size_t>(def.width) * def.height);
+                for (int y = 0; y < def.height; y++) {
+                    for (int x = 0; x < def.width; x++) {
+                        cells.push_back(get(x, y));
+                    }
+                }
+                return cells;
+            }
+        };
+
+        // Packs one line into its row (guard words included, zeroed by the caller). Cells past the grid width are ignored.
+        inline void pack_row(const char* line, size_t len, int width, uint64_t* row) {
+            const size_t cells = std::min(len, static_cast<size_t>(width));
+            for (size_t i = 0; i < cells; i++) {
+                row[1 + i / 64] |= static_cast<uint64_t>(line[i] == '@') << (i % 64);
+            }
+        }
+
+        // Bit-sliced neighbor counting: for 64 cells at once, sum the 8 shifted neighbor planes with full adders.
+        // ones + 2 * (c1 + c2 + c3 + c4) is the neighbor count and ones <= 1, so "at least 4 neighbors" is exactly
+        // "at least two of the carries c1..c4 set".
+        inline void full_add(uint64_t a, uint64_t b, uint64_t c, uint64_t& sum, uint64_t& carry) {
+            const uint64_t ab = a ^ b;
+            sum = ab ^ c;
+            carry = (a & b) | (c & ab);
+        }
+
+        // Marks the rolls of one row that have fewer than 4 neighboring rolls. Rows are passed with their guard words.
+        inline void movable_row(const uint64_t* above, const uint64_t* row, const uint64_t* below,
+                                uint64_t* out, size_t word_count) {
+            for (size_t w = 1; w <= word_count; w++) {
+                // west: bit x holds cell x - 1, east: bit x holds cell x + 1
+                const uint64_t above_west = (above[w] << 1) | (above[w - 1] >> 63);
+                const uint64_t above_east = (above[w] >> 1) | (above[w + 1] << 63);
+                const uint64_t row_west = (row[w] << 1) | (row[w - 1] >> 63);
+                const uint64_t row_east = (row[w] >> 1) | (row[w + 1] << 63);
+                const uint64_t below_west = (below[w] << 1) | (below[w - 1] >> 63);
+                const uint64_t below_east = (below[w] >> 1) | (below[w + 1] << 63);
+
+                uint64_t s1, c1, s2, c2, ones, c4;
+                full_add(above_west, above[w], above_east, s1, c1);
+                full_add(below_west, below[w], below_east, s2, c2);
+                const uint64_t s3 = row_west ^ row_east;
+                const uint64_t c3 = row_west & row_east;
+                full_add(s1, s2, s3, ones, c4);
+
+                const uint64_t at_least_four = (c1 & c2) | (c3 & c4) | ((c1 | c2) & (c3 | c4));
+                out[w] = row[w] & ~at_least_four;
+            }
+        }
+
+        // movable has the same layout as grid.words; guard words stay zero.
+        inline void movable_mask_generic(const PackedGrid& grid, std::vector<uint64_t>& movable) {
+            movable.assign(grid.words.size(), 0);
+            for (int y = 0; y < grid.def.height; y++) {
+                movable_row(grid.row(y - 1), grid.row(y), grid.row(y + 1),
+                            movable.data() + (y + 1) * grid.stride, grid.word_count());
+            }
+        }
+
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+        // Same loop compiled for AVX2: the word loop vectorizes to 256 cells per step.
+        FAST_IO_TARGET("avx2")
+        inline void movable_mask_avx2(const PackedGrid& grid, std::vector<uint64_t>& movable) {
+            movable.assign(grid.words.size(), 0);
+            for (int y = 0; y < grid.def.height; y++) {
+                movable_row(grid.row(y - 1), grid.row(y), grid.row(y + 1),
+                            movable.data() + (y + 1) * grid.stride, grid.word_count());
+            }
+        }
+#endif
+
+        inline void movable_mask(const PackedGrid& grid, std::vector<uint64_t>& movable) {
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+            if (fast_io::simd_level() >= fast_io::SimdLevel::AVX2) {
+                movable_mask_avx2(grid, movable);
+                return;
+            }
+#endif
+            movable_mask_generic(grid, movable);
+        }
+
+        // Cache-sized piece of the packed grid: 64 rows of 64 words (4096 cells), 32 KiB of grid words.
+        constexpr int TILE_ROWS = 64;
+        constexpr size_t TILE_WORDS = 64;
+
+        struct Tile {
+            int first_row = 0;
+            int last_row = 0;
+            size_t first_word = 1;  // words as numbered by movable_row, guard word 0 excluded
+            size_t last_word = 1;
+            size_t cells = 0;       // grid cells covered, padding bits of the last word excluded
+        };
+
+        // Row-major tiles of a grid, with the up to 8 tiles around each one.
+        struct TileGrid {
+            size_t columns = 0;
+            size_t rows = 0;
+            std::vector<Tile> tiles;
+
+            explicit TileGrid(const PackedGrid& grid)
+                : columns((grid.word_count() + TILE_WORDS - 1) / TILE_WORDS),
+                  rows((static_cast<size_t>(grid.def.height) + TILE_ROWS - 1) / TILE_ROWS) {
+                if (grid.def.width == 0) columns = rows = 0;
+                tiles.reserve(columns * rows);
+                for (size_t ty = 0; ty < rows; ty++) {
+                    for (size_t tx = 0; tx < columns; tx++) {
+                        Tile tile;
+                        tile.first_row = static_cast<int>(ty) * TILE_ROWS;
+                        tile.last_row = std::min(tile.first_row + TILE_ROWS, grid.def.height);
+                        tile.first_word = 1 + tx * TILE_WORDS;
+                        tile.last_word = std::min(tile.first_word + TILE_WORDS, grid.word_count() + 1);
+                        const size_t first_cell = tx * TILE_WORDS * 64;
+                        const size_t row_cells = std::min(TILE_WORDS * 64,
+                                                          static_cast<size_t>(grid.def.width) - first_cell);
+                        tile.cells = row_cells * static_cast<size_t>(tile.last_row - tile.first_row);
+                        tiles.push_back(tile);
+                    }
+                }
+            }
+
+            template<typename Visit>
+            void for_each_neighborhood_tile(size_t t, Visit&& visit) const {
+                const size_t tx = t % columns;
+                const size_t ty = t / columns;
+                for (size_t y = ty > 0 ? ty - 1 : 0; y <= std::min(ty + 1, rows - 1); y++) {
+                    for (size_t x = tx > 0 ? tx - 1 : 0; x <= std::min(tx + 1, columns - 1); x++) {
+                        visit(y * columns + x);
+                    }
+                }
+            }
+        };
+
+        // movable_row over the rows and words of one tile. Its one-cell halo (the rows above and below, the words on
+        // either side) is read straight from the shared grid, which no thread writes while masks are computed.
+        // Returns the number of movable rolls in the tile.
+        inline size_t movable_tile_generic(const PackedGrid& grid, const Tile& tile, std::vector<uint64_t>& movable) {
+            const size_t w = tile.first_word - 1;
+            const size_t word_count = tile.last_word - tile.first_word;
+            size_t count = 0;
+            for (int y = tile.first_row; y < tile.last_row; y++) {
+                uint64_t* out = movable.data() + (y + 1) * grid.stride + w;
+                movable_row(grid.row(y - 1) + w, grid.row(y) + w, grid.row(y + 1) + w, out, word_count);
+                for (size_t i = 1; i <= word_count; i++) count += std::popcount(out[i]);
+            }
+            return count;
+        }
+
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+        FAST_IO_TARGET("avx2")
+        inline size_t movable_tile_avx2(const PackedGrid& grid, const Tile& tile, std::vector<uint64_t>& movable) {
+            const size_t w = tile.first_word - 1;
+            const size_t word_count = tile.last_word - tile.first_word;
+            size_t count = 0;
+            for (int y = tile.first_row; y < tile.last_row; y++) {
+                uint64_t* out = movable.data() + (y + 1) * grid.stride + w;
+                movable_row(grid.row(y - 1) + w, grid.row(y) + w, grid.row(y + 1) + w, out, word_count);
+                for (size_t i = 1; i <= word_count; i++) count += std::popcount(out[i]);
+            }
+            return count;
+        }
+#endif
+
+        inline size_t movable_tile(const PackedGrid& grid, const Tile& tile, std::vector<uint64_t>& movable) {
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+            if (fast_io::simd_level() >= fast_io::SimdLevel::AVX2) return movable_tile_avx2(grid, tile, movable);
+#endif
+            return movable_tile_generic(grid, tile, movable);
+        }
+
+        inline void remove_tile(PackedGrid& grid, const Tile& tile, const std::vector<uint64_t>& movable) {
+            for (int y = tile.first_row; y < tile.last_row; y++) {
+                uint64_t* row = grid.row(y);
+                const uint64_t* out = movable.data() + (y + 1) * grid.stride;
+                for (size_t w = tile.first_word; w < tile.last_word; w++) row[w] &= ~out[w];
+            }
+        }
+    }
+
+    struct Input {
+        PaperRolls::PackedGrid grid;
+    };
+
+    enum class SolveMode {
+        BitPacked,  // default: word-parallel neighbor counting, 64 cells per operation
+        Worklist,   // neighbor counts computed once, then only the removal frontier is touched
+        Tiled,      // BitPacked on cache-sized tiles across threads, skipping tiles the last wave did not touch
+        Naive,      // per-cell neighbor visits
+        Check,      // run all solvers and compare
+    };
+
+    struct Answer {
+        unsigned int movable_count = 0;  //part 1
+        unsigned int removed_count = 0;  //part 2
+        std::vector<unsigned int> wave_removals;  // rolls removed per wave; not filled by solve_naive
+        uint64_t cells_evaluated = 0;  // solve_tiled only: cells whose neighbors were counted, over all waves
+    };
+
+    // The line index gives the grid height up front, so the packed grid is allocated once (guard rows included) and
+    // the rows are packed in place, an equal share of them per thread.
+    inline std::optional<fast_io::ReadStats> parse(const char* path, Input& input, bool debug = false) {
+        INSTRUMENT_SCOPE("parse");
+        PaperRolls::PackedGrid& grid = input.grid;
+        return fast_io::read_indexed(
+            path,
+            [&](const fast_io::LineIndex& index) {
+                if (index.empty()) return;
+                grid.def.width = static_cast<int>(index.line(0).size());
+                grid.def.height = static_cast<int>(index.size());
+                grid.stride = PaperRolls::PackedGrid::stride_for(grid.def.width);
+                grid.words.assign(grid.stride * (index.size() + 2), 0);
+                fast_io::parallel_for_lines(index.split(index.thread_count()), [&](size_t, fast_io::LineRange range) {
+                    for (size_t y = range.first; y < range.last; y++) {
+                        const std::string_view line = index.line(y);
+                        PaperRolls::pack_row(line.data(), line.size(), grid.def.width,
+                                             grid.words.data() + (y + 1) * grid.stride);
+                    }
+                });
+            },
+            {}, debug);
+    }
+
+    inline Answer solve_naive(const Input& input) {
+        const grid::GridDef& def = input.grid.def;
+        grid::Grid<uint8_t> grid(def);  // part 2 removes rolls in place
+        for (int y = 0; y < def.height; y++) {
+            for (int x = 0; x < def.width; x++) {
+                grid(x, y) = input.grid.get(x, y);
+            }
+        }
+        const auto is_roll = [](const uint8_t cell) { return cell != 0; };
+
+        unsigned int movable_count = 0;
+        grid.for_each_index([&](const grid::GridIndex i) {
+            if (!grid[i])
+                return; //count only for cells with a roll in it.
+
+            if (grid.count_neighbors<grid::Neighbors8>(i, is_roll) < 4)
+                movable_count++;
+        });
+
+        Answer answer;
+        answer.movable_count = movable_count;
+
+        INSTRUMENT_SCOPE("waves");
+        unsigned int removed_count = movable_count;
+        movable_count = 0;
+
+        while (removed_count > 0) {
+            removed_count = 0;
+            grid.for_each_index([&](const grid::GridIndex i) {
+                if (!grid[i])
+                    return;
+
+                if (grid.count_neighbors<grid::Neighbors8>(i, is_roll) < 4) {
+                    removed_count++;
+                    grid[i] = 0; //remove the roll.
+                }
+            });
+            movable_count += removed_count;
+        }
+
+        answer.removed_count = movable_count;
+        return answer;
+    }
+
+    // Part 2 peels in waves: every roll that is movable in the current grid is removed at once. The set of rolls that
+    // can eventually be removed does not depend on removal order, so the total matches the in-place sweep of solve_naive.
+    inline Answer solve_bitpacked(const Input& input) {
+        PaperRolls::PackedGrid grid = input.grid;
+        std::vector<uint64_t> movable;
+
+        Answer answer;
+        size_t removed = 0;
+        {
+            INSTRUMENT_SCOPE("part1");
+            PaperRolls::movable_mask(grid, movable);
+            for (const uint64_t word : movable) removed += std::popcount(word);
+            answer.movable_count = static_cast<unsigned int>(removed);
+        }
+
+        INSTRUMENT_SCOPE("waves");
+        while (removed > 0) {
+            answer.removed_count += static_cast<unsigned int>(removed);
+            answer.wave_removals.push_back(static_cast<unsigned int>(removed));
+            for (size_t i = 0; i < grid.words.size(); i++) {
+                grid.words[i] &= ~movable[i];
+            }
+            PaperRolls::movable_mask(grid, movable);
+            removed = 0;
+            for (const uint64_t word : movable) removed += std::popcount(word);
+        }
+        return answer;
+    }
+
+    // Incremental peeling. Every cell gets one byte: a roll flag, a queued flag and its neighbor count. Counts are
+    // computed once; removing a roll decrements its neighbors, and a neighbor that drops below 4 joins the next wave.
+    // Total work is O(cells + removals) instead of O(cells * waves), with the same waves as solve_bitpacked.
+    inline Answer solve_worklist(const Input& input) {
+        constexpr uint8_t ROLL = 0x80;
+        constexpr uint8_t QUEUED = 0x40;
+        constexpr uint8_t COUNT_MASK = 0x0F;
+
+        const grid::GridDef& def = input.grid.def;
+        grid::Grid<uint8_t> rolls(def);
+        for (int y = 0; y < def.height; y++) {
+            for (int x = 0; x < def.width; x++) {
+                rolls(x, y) = input.grid.get(x, y);
+            }
+        }
+
+        // Neighbor counts for every cell in one vectorizable pass, then folded into the flag byte of each roll.
+        grid::Grid<uint8_t> cells(def);
+        rolls.accumulate_neighbors<grid::Neighbors8>(cells, [](const uint8_t roll) { return roll; });
+        const auto offsets = cells.neighbor_offsets<grid::Neighbors8>();
+
+        std::vector<uint32_t> wave;
+        cells.for_each_index([&](const grid::GridIndex i) {
+            if (!rolls[i]) {
+                cells[i] = 0;
+                return;
+            }
+            cells[i] |= ROLL;
+            if ((cells[i] & COUNT_MASK) < 4) {
+                cells[i] |= QUEUED;
+                wave.push_back(static_cast<uint32_t>(i));
+            }
+        });
+
+        Answer answer;
+        answer.movable_count = static_cast<unsigned int>(wave.size());
+
+        INSTRUMENT_SCOPE("waves");  // the rest of solve is the neighbor count pass
+        std::vector<uint32_t> next_wave;
+        while (!wave.empty()) {
+            answer.removed_count += static_cast<unsigned int>(wave.size());
+            answer.wave_removals.push_back(static_cast<unsigned int>(wave.size()));
+
+            // Whole wave leaves first, so neighbors inside the same wave are not decremented.
+            for (const uint32_t i : wave) cells[i] = 0;
+            for (const uint32_t i : wave) {
+                for (const grid::GridIndex offset : offsets) {
+                    uint8_t& neighbor = cells[i + offset];
+                    if ((neighbor & (ROLL | QUEUED)) != ROLL) continue;
+                    --neighbor;
+                    if ((neighbor & COUNT_MASK) < 4) {
+                        neighbor |= QUEUED;
+                        next_wave.push_back(static_cast<uint32_t>(i + offset));
+                    }
+                }
+            }
+            wave.swap(next_wave);
+            next_wave.clear();
+        }
+        return answer;
+    }
+
+    // solve_bitpacked on tiles. Every wave computes the masks of the dirty tiles in parallel, then (after all masks are
+    // done, so no tile sees a neighbor's halo change mid-wave) removes them. A tile can only have movable rolls in the
+    // next wave if a roll was removed in it or in one of the 8 tiles around it, so only those tiles stay dirty.
+    // Waves and counts are exactly those of solve_bitpacked.
+    inline Answer solve_tiled(const Input& input) {
+        PaperRolls::PackedGrid grid = input.grid;
+        std::vector<uint64_t> movable(grid.words.size(), 0);
+        const PaperRolls::TileGrid tiles(grid);
+
+        std::vector<uint32_t> dirty(tiles.tiles.size());
+        for (size_t t = 0; t < dirty.size(); t++) dirty[t] = static_cast<uint32_t>(t);
+        std::vector<size_t> removed(tiles.tiles.size(), 0);  // by the tile in the current wave
+        std::vector<uint8_t> marked(tiles.tiles.size(), 0);
+        std::vector<uint32_t> next_dirty;
+
+        Answer answer;
+        bool first_wave = true;
+        INSTRUMENT_SCOPE("waves");
+        while (!dirty.empty()) {
+            threading::parallel_for(0, dirty.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    removed[dirty[i]] = PaperRolls::movable_tile(grid, tiles.tiles[dirty[i]], movable);
+                }
+            });
+
+            size_t wave = 0;
+            for (const uint32_t t : dirty) {
+                wave += removed[t];
+                answer.cells_evaluated += tiles.tiles[t].cells;
+            }
+            if (first_wave) answer.movable_count = static_cast<unsigned int>(wave);
+            first_wave = false;
+            if (wave == 0) break;
+            answer.removed_count += static_cast<unsigned int>(wave);
+            answer.wave_removals.push_back(static_cast<unsigned int>(wave));
+
+            threading::parallel_for(0, dirty.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    if (removed[dirty[i]] > 0) PaperRolls::remove_tile(grid, tiles.tiles[dirty[i]], movable);
+                }
+            });
+
+            next_dirty.clear();
+            for (const uint32_t t : dirty) {
+                if (removed[t] == 0) continue;
+                tiles.for_each_neighborhood_tile(t, [&](size_t neighbor) {
+                    if (marked[neighbor]) return;
+                    marked[neighbor] = 1;
+                    next_dirty.push_back(static_cast<uint32_t>(neighbor));
+                });
+            }
+            for (const uint32_t t : next_dirty) marked[t] = 0;
+            dirty.swap(next_dirty);
+        }
+        return answer;
+    }
+
+    inline Answer solve(const Input& input, SolveMode mode = SolveMode::BitPacked) {
+        INSTRUMENT_SCOPE("solve");
+        switch (mode) {
+            case SolveMode::Naive: return solve_naive(input);
+            case SolveMode::Worklist: return solve_worklist(input);
+            case SolveMode::Tiled: return solve_tiled(input);
+            default: return solve_bitpacked(input);
+        }
+    }
+}
+
+#endif
@@ -1,164 +1,113 @@
-
-
+#include <cstring>
 #include <iostream>
-#include <unordered_set>
-
-#include "fast-io.hpp"
+#include <string>
+#include <vector>
 
-namespace Inventory {
+#include "batch-runner.hpp"
+#include "instrument.hpp"
+#include "solution.hpp"
 
-    using IdType = uint64_t;
-
-    template<typename IntType>
-    inline std::pair<IntType, IntType> parse_pair(const char* str, size_t len, char delimiter = '-') {
-        IntType first = 0;
-        IntType second = 0;
-        size_t i = 0;
-
-        while (i < len && str[i] != delimiter) {
-            first = first * 10 + (str[i] - '0');
-            ++i;
-        }
+constexpr bool DEBUG_FAST_IO = true;
 
-        ++i; // skip delimiter
 
-        while (i < len) {
-            second = second * 10 + (str[i] - '0');
-            ++i;
+int main(int argc, char* argv[]) {
+    const char* path = nullptr;
+    std::vector<std::string> inputs;
+    day5::SolveMode mode = day5::SolveMode::Eytzinger;
+    const char* profile_path = nullptr;  // --profile FILE: per-phase JSON report, "-" for stdout
+    bool batch_mode = false;  // --batch: every argument is a file, directory or @manifest
+    batch::Options batch_options;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--sweep") == 0) {
+            mode = day5::SolveMode::Sweep;
+        } else if (std::strcmp(argv[i], "--binary-search") == 0) {
+            mode = day5::SolveMode::BinarySearch;
+        } else if (std::strcmp(argv[i], "--incremental") == 0) {
+            mode = day5::SolveMode::Incremental;
+        } else if (std::strcmp(argv[i], "--check") == 0) {
+            mode = day5::SolveMode::Check;
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profile_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--counters") == 0) {
+            if (!instrument::Profiler::instance().enable_counters()) {
+                std::cerr << "Hardware counters unavailable, timing only" << std::endl;
+            }
+        } else if (std::strcmp(argv[i], "--batch") == 0) {
+            batch_mode = true;
+        } else if (batch::parse_option(argc, argv, i, batch_options)) {
+            continue;
+        } else {
+            path = argv[i];
+            inputs.push_back(argv[i]);
         }
-
-        return {first, second};
     }
 
-    inline bool is_empty_line(size_t len) {
-        return len == 0;
-    }
-
-    inline bool is_blank_line(const char* line, size_t len) {
-        if (len == 0) return true;
-        for (size_t i = 0; i < len; i++) {
-            if (line[i] != ' ' && line[i] != '\t') return false;
+    if (batch_mode) {
+        std::vector<std::string> files;
+        if (!batch::collect_inputs(inputs, files)) return 1;
+        const int status = batch::run(files, {"fresh", "total_range_size"}, [&](const char* file) {
+            return batch::solve_file<day5::Input>(
+                file, day5::parse,
+                [&](const day5::Input& input) { return day5::solve(input, mode); },
+                [](const day5::Answer& answer) { return std::vector<std::string>{std::to_string(answer.fresh_count), std::to_string(answer.total_range_size)}; },
+                [](const day5::Input& input, const day5::Answer&) { return day5::input_error(input); });
+        }, batch_options);
+        if (profile_path != nullptr && !instrument::write_report(profile_path, "day_5", "batch")) {
+            std::cerr << "Can't write profile: " << profile_path << std::endl;
+            return 1;
         }
-        return true;
+        return status;
     }
 
-    struct IdRange {
-        IdType first = 0;
-        IdType last = 0;
-
-        [[nodiscard]] bool contains(IdType id) const {
-            return first <= id && id <= last;
-        }
-
-        bool operator<(const IdRange& other) const {
-            return first < other.first;
-        }
-
-        [[nodiscard]] uint64_t size() const {
-            return static_cast<uint64_t>( last - first + 1); //inclusive count
-        }
-    };
-
-}
-
-
-constexpr bool DEBUG_FAST_IO = true;
-
-
-int main(int argc, char* argv[]) {
-    const char* path = nullptr;
-
-    if (argc < 2) {
+    if (path == nullptr) {
         std::cout << "Using default data file: ./data.txt" << std::endl;
         path = "./data.txt";
     } else {
-        std::cout << "Using supplied data file: " << argv[1] << std::endl;
-        path = argv[1];
+        std::cout << "Using supplied data file: " << path << std::endl;
     }
 
-    std::vector<Inventory::IdRange> fresh_ids;
-    fresh_ids.reserve(8096); //no idea about the size of the input data, but should be enough to avoid reallocation
-    std::vector<Inventory::IdType> ids;
-    ids.reserve(8096);
-
-    auto stats = fast_io::read_lines(
-        path,
-        [&](const char* line, size_t len) {
-            // fast_io line parsing skips empty lines - so detect type of input based on pattern.
-            bool is_range = false;
-            for (size_t i = 0; i < len; i++) {
-                if (line[i] == '-') {
-                    is_range = true;
-                    break;
-                }
-            }
-
-            if (is_range) {
-                const auto [first, last] = Inventory::parse_pair<Inventory::IdType>(line, len);
-                fresh_ids.push_back({first, last});
-            } else {
-                const auto id = fast_io::parse_int<Inventory::IdType>(line, len);
-                ids.push_back(id);
-            }
-        },
-        DEBUG_FAST_IO);
+    day5::Input input;
+    auto stats = day5::parse(path, input, DEBUG_FAST_IO);
 
     if (!stats) {
         std::cerr << "Can't open file: " << path << std::endl;
         return 1;
     }
+    if (const std::string error = day5::input_error(input); !error.empty()) {
+        std::cerr << "Bad input: " << error << std::endl;
+        return 1;
+    }
 
-    std::cout << "fresh id ranges (pre merge): " << fresh_ids.size() << std::endl;
-
-    // sort our fresh id ranges and then merge them for faster lookups
-    {
-        std::sort(fresh_ids.begin(), fresh_ids.end(), [](const auto& a, const auto& b) {
-           return a.first < b.first;
-       });
-
-        std::vector<Inventory::IdRange> merged;
-        merged.reserve(fresh_ids.size());
-        for (const auto& range : fresh_ids) {
-            if (merged.empty() || merged.back().last + 1 < range.first) {
-                merged.push_back(range);
-            } else {
-                merged.back().last = std::max(merged.back().last, range.last);
+    const day5::Answer answer = day5::solve(input, mode);
+
+    if (mode == day5::SolveMode::Check) {
+        const std::pair<const char*, day5::SolveMode> candidates[] {
+            {"sweep", day5::SolveMode::Sweep},
+            {"binary search", day5::SolveMode::BinarySearch},
+            {"incremental", day5::SolveMode::Incremental},
+        };
+        for (const auto& [name, candidate_mode] : candidates) {
+            const day5::Answer candidate = day5::solve(input, candidate_mode);
+            if (candidate.fresh_count != answer.fresh_count || candidate.merged_range_count != answer.merged_range_count
+                || candidate.total_range_size != answer.total_range_size) {
+                std::cerr << "Mismatch: " << name << " " << candidate.fresh_count << "/" << candidate.total_range_size
+                          << " vs eytzinger " << answer.fresh_count << "/" << answer.total_range_size << std::endl;
+                return 1;
             }
         }
-        fresh_ids = std::move(merged);
     }
 
-    std::cout << "fresh id ranges (post merge): " << fresh_ids.size() << std::endl;
-    std::cout << "number of active ids: " << ids.size() << std::endl;
-
-    auto is_fresh = [&](const Inventory::IdType& id) -> bool {
-        //find first range where start > id
-        auto it = std::upper_bound(fresh_ids.begin(), fresh_ids.end(), id,
-            [](const Inventory::IdType val, const Inventory::IdRange& range) {
-                return val < range.first;
-            });
+    std::cout << "fresh id ranges (pre merge): " << input.fresh_ids.size() << std::endl;
+    std::cout << "fresh id ranges (post merge): " << answer.merged_range_count << std::endl;
+    std::cout << "number of active ids: " << input.ids.size() << std::endl;
 
-        //check the range before (if exists) - it has start <= id
-        if (it != fresh_ids.begin()) {
-            --it;
-            if (id <= it->last) return true;
-        }
-        return false;
-    };
+    std::cout << "fresh ingredients :" << answer.fresh_count << std::endl;
+    std::cout << "total range size: " << answer.total_range_size << std::endl;
 
-
-    unsigned int fresh_count = 0;
-    for (const Inventory::IdType& id : ids) {
-        if (is_fresh(id))
-            ++fresh_count;
-    }
-
-    uint64_t total_range_size = 0;
-    for (const auto& range : fresh_ids) {
-        total_range_size += range.size();
+    if (profile_path != nullptr && !instrument::write_report(profile_path, "day_5", path)) {
+        std::cerr << "Can't write profile: " << profile_path << std::endl;
+        return 1;
     }
-
-    std::cout << "fresh ingredients :" <<fresh_count << std::endl;
-    std::cout << "total range size: " << total_range_size << std::endl;
     return 0;
 }
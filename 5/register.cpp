@@ -0,0 +1,16 @@
+#include <string>
+#include <vector>
+
+#include "solution.hpp"
+#include "solver-registry.hpp"
+
+// Day 5 entry for the aoc driver.
+namespace {
+    const registry::Registration DAY5{{5, {"fresh", "total_range_size"}, [](const char* path) {
+        return batch::solve_file<day5::Input>(
+            path, day5::parse,
+            [](const day5::Input& input) { return day5::solve(input); },
+            [](const day5::Answer& answer) { return std::vector<std::string>{std::to_string(answer.fresh_count), std::to_string(answer.total_range_size)}; },
+            [](const day5::Input& input, const day5::Answer&) { return day5::input_error(input); });
+    }}};
+}
@@ -0,0 +1,251 @@
+#ifndef DAY5_SOLUTION_HPP
+#define DAY5_SOLUTION_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "fast-io.hpp"
+#include "instrument.hpp"
+#include "interval-set.hpp"
+#include "thread-pool.hpp"
+
+namespace day5 {
+
+    namespace Inventory {
+
+        using IdType = uint64_t;
+
+        inline bool is_empty_line(size_t len) {
+            return len == 0;
+        }
+
+        inline bool is_blank_line(const char* line, size_t len) {
+            if (len == 0) return true;
+            for (size_t i = 0; i < len; i++) {
+                if (line[i] != ' ' && line[i] != '\t') return false;
+            }
+            return true;
+        }
+
+        using IdRange = intervals::Interval<IdType>;
+        using IdSet = intervals::IntervalSet<IdType>;  // merged ranges, coalesced as they are inserted
+
+        // Per-section line parser for fast_io::read_sections. The ranges come first, then a blank line, then the ids,
+        // but the record format is taken from the line itself (a '-' makes it a range), so a missing or extra blank
+        // line does not move lines into the wrong list. Lines that are neither are counted, not skipped silently.
+        struct InputParser {
+            std::vector<IdRange> fresh_ids;
+            std::vector<IdType> ids;
+            size_t malformed_lines = 0;
+            std::string first_malformed;
+
+            explicit InputParser(const fast_io::Section& section) {
+                if (section.index == 0) fresh_ids.reserve(section.line_count);
+                else ids.reserve(section.line_count);
+            }
+
+            void operator()(const char* line, size_t len) {
+                bool parsed = false;
+                if (std::memchr(line, '-', len) != nullptr) {
+                    parsed = fast_io::format<"{u64}-{u64}">.apply(line, len, [&](IdType first, IdType last) {
+                        fresh_ids.push_back({first, last});
+                    });
+                } else {
+                    parsed = fast_io::format<"{u64}">.apply(line, len, [&](IdType id) { ids.push_back(id); });
+                }
+                if (parsed || is_blank_line(line, len)) return;
+                if (malformed_lines++ == 0) first_malformed.assign(line, len);
+            }
+        };
+
+        inline void prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address);
+#else
+            (void)address;
+#endif
+        }
+
+        // One std::upper_bound per id over the merged ranges.
+        inline size_t count_fresh_binary_search(const std::vector<IdRange>& merged, const std::vector<IdType>& ids) {
+            auto is_fresh = [&](const IdType& id) -> bool {
+                //find first range where start > id
+                auto it = std::upper_bound(merged.begin(), merged.end(), id,
+                    [](const IdType val, const IdRange& range) {
+                        return val < range.first;
+                    });
+
+                //check the range before (if exists) - it has start <= id
+                if (it != merged.begin()) {
+                    --it;
+                    if (id <= it->last) return true;
+                }
+                return false;
+            };
+
+            size_t fresh_count = 0;
+            for (const IdType& id : ids) {
+                if (is_fresh(id))
+                    ++fresh_count;
+            }
+            return fresh_count;
+        }
+
+        // Sorts a copy of the ids and walks them alongside the merged ranges. Both passes are sequential, so for batches
+        // as large as the range set this beats any per-id search.
+        inline size_t count_fresh_sweep(const std::vector<IdRange>& merged, std::vector<IdType> ids) {
+            std::sort(ids.begin(), ids.end());
+
+            size_t fresh_count = 0;
+            size_t r = 0;
+            for (const IdType id : ids) {
+                while (r < merged.size() && merged[r].last < id) ++r;
+                if (r == merged.size()) break;
+                if (merged[r].first <= id) ++fresh_count;
+            }
+            return fresh_count;
+        }
+
+        // Merged ranges in Eytzinger (BFS) order: node k has children 2k and 2k+1, so the top levels of the search share
+        // a few cache lines and the next levels can be prefetched. Last ids are searched on their own (8 per cache line);
+        // first ids are only read once per query.
+        class RangeIndex {
+        public:
+            explicit RangeIndex(const std::vector<IdRange>& merged)
+                : firsts_(merged.size() + 1), lasts_(merged.size() + 1) {
+                INSTRUMENT_SCOPE("index");
+                size_t next = 0;
+                build(merged, next, 1);
+            }
+
+            // Branchless lower bound on last id: the first range with last >= id is the only one that can contain it.
+            [[nodiscard]] bool contains(IdType id) const {
+                const size_t n = lasts_.size() - 1;
+                size_t k = 1;
+                while (k <= n) {
+                    prefetch(lasts_.data() + k * PREFETCH_STRIDE);
+                    k = 2 * k + (lasts_[k] < id);
+                }
+                k >>= std::countr_one(k) + 1;  // undo the right turns taken after the last left turn
+                return k != 0 && firsts_[k] <= id;
+            }
+
+            // Queries are independent, so they are counted on the work-stealing pool.
+            [[nodiscard]] size_t count_contained(const std::vector<IdType>& ids) const {
+                return threading::parallel_reduce(0, ids.size(), QUERY_GRAIN, [&](size_t begin, size_t end) {
+                    uint64_t count = 0;
+                    for (size_t i = begin; i < end; i++) count += contains(ids[i]);
+                    return count;
+                });
+            }
+
+        private:
+            // Descendants three levels down are 8 consecutive nodes, one cache line of last ids.
+            static constexpr size_t PREFETCH_STRIDE = 8;
+            static constexpr size_t QUERY_GRAIN = 16 * 1024;  // ids per stealing pool task
+
+            void build(const std::vector<IdRange>& merged, size_t& next, size_t k) {
+                if (k > merged.size()) return;
+                build(merged, next, 2 * k);
+                firsts_[k] = merged[next].first;
+                lasts_[k] = merged[next].last;
+                ++next;
+                build(merged, next, 2 * k + 1);
+            }
+
+            std::vector<IdType> firsts_;
+            std::vector<IdType> lasts_;
+        };
+    }
+
+    struct Input {
+        std::vector<Inventory::IdRange> fresh_ids;
+        std::vector<Inventory::IdType> ids;
+        size_t malformed_lines = 0;   // neither a range nor an id
+        std::string first_malformed;  // the first of them, in file order
+    };
+
+    enum class SolveMode {
+        Eytzinger,     // branchless search over the merged ranges in BFS order
+        Sweep,         // sort the ids, then one merge pass
+        BinarySearch,  // std::upper_bound per id
+        Incremental,   // insert the ranges one by one into the interval set, query it directly
+        Check,         // Eytzinger; main compares against the other modes
+    };
+
+    struct Answer {
+        size_t merged_range_count = 0;
+        unsigned int fresh_count = 0;   //part 1
+        uint64_t total_range_size = 0;  //part 2
+    };
+
+    inline std::optional<fast_io::ReadStats> parse(const char* path, Input& input, bool debug = false) {
+        INSTRUMENT_SCOPE("parse");
+        return fast_io::read_sections(
+            path,
+            [](const fast_io::Section& section) { return Inventory::InputParser(section); },
+            [&](Inventory::InputParser&& section) {
+                if (input.fresh_ids.empty()) input.fresh_ids = std::move(section.fresh_ids);
+                else input.fresh_ids.insert(input.fresh_ids.end(), section.fresh_ids.begin(), section.fresh_ids.end());
+                if (input.ids.empty()) input.ids = std::move(section.ids);
+                else input.ids.insert(input.ids.end(), section.ids.begin(), section.ids.end());
+                if (input.malformed_lines == 0) input.first_malformed = std::move(section.first_malformed);
+                input.malformed_lines += section.malformed_lines;
+            },
+            {}, debug);
+    }
+
+    // Why the parsed input can't be trusted, empty if it is fine.
+    inline std::string input_error(const Input& input) {
+        if (input.malformed_lines == 0) return {};
+        return std::to_string(input.malformed_lines) + " malformed line(s), first: " + input.first_malformed;
+    }
+
+    inline Inventory::IdSet merge_fresh_ids(const Input& input, SolveMode mode) {
+        INSTRUMENT_SCOPE("merge");
+        Inventory::IdSet fresh_ids;
+        if (mode == SolveMode::Incremental) {
+            for (const auto& range : input.fresh_ids) fresh_ids.insert(range);  // as if streamed in, no sort
+        } else {
+            // sort our fresh id ranges once and bulk load them, merging in the same pass
+            std::vector<Inventory::IdRange> sorted = input.fresh_ids;
+            std::sort(sorted.begin(), sorted.end());
+            fresh_ids.assign_sorted(sorted.begin(), sorted.end());
+        }
+        return fresh_ids;
+    }
+
+    inline size_t count_fresh(const Inventory::IdSet& fresh_ids, const Input& input, SolveMode mode) {
+        INSTRUMENT_SCOPE("queries");
+        switch (mode) {
+            case SolveMode::Incremental:
+                return fresh_ids.count_contained(input.ids);
+            case SolveMode::Sweep:
+                return Inventory::count_fresh_sweep(fresh_ids.to_vector(), input.ids);
+            case SolveMode::BinarySearch:
+                return Inventory::count_fresh_binary_search(fresh_ids.to_vector(), input.ids);
+            default:
+                return Inventory::RangeIndex(fresh_ids.to_vector()).count_contained(input.ids);
+        }
+    }
+
+    inline Answer solve(const Input& input, SolveMode mode = SolveMode::Eytzinger) {
+        INSTRUMENT_SCOPE("solve");
+        const Inventory::IdSet fresh_ids = merge_fresh_ids(input, mode);
+        const size_t fresh_count = count_fresh(fresh_ids, input, mode);
+
+        Answer answer;
+        answer.merged_range_count = fresh_ids.size();
+        answer.fresh_count = static_cast<unsigned int>(fresh_count);
+        answer.total_range_size = fresh_ids.total_size();
+        return answer;
+    }
+}
+
+#endif
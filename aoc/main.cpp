@@ -0,0 +1,125 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "batch-runner.hpp"
+#include "solver-registry.hpp"
+#include "thread-pool.hpp"
+
+// One driver for every registered day.
+// usage: aoc [--sequential] [--threads N] [day | day=path]...   (default: every day on its own data.txt)
+// Days run concurrently on one thread pool unless --sequential is given, which runs them one at a time so their
+// timings do not disturb each other.
+
+#ifndef AOC_DATA_DIR
+#define AOC_DATA_DIR "."
+#endif
+
+namespace {
+
+    struct Job {
+        const registry::Solver* solver = nullptr;
+        std::string path;
+        batch::FileResult result;
+        double wall_ms = 0.0;  // parse + solve as seen from the driver
+    };
+
+    void run_job(Job& job) {
+        const auto start = std::chrono::steady_clock::now();
+        job.result = job.solver->solve_file(job.path.c_str());
+        const auto end = std::chrono::steady_clock::now();
+        job.wall_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    std::string join_answers(const Job& job) {
+        std::ostringstream answers;
+        for (size_t a = 0; a < job.result.answers.size(); ++a) {
+            if (a > 0) answers << "  ";
+            answers << job.solver->answer_names[a] << '=' << job.result.answers[a];
+        }
+        return answers.str();
+    }
+
+    void print_table(const std::vector<Job>& jobs) {
+        std::cout << "day    parse_ms    solve_ms    total_ms       lines  answers\n";
+        for (const Job& job : jobs) {
+            std::cout << std::setw(3) << job.solver->day;
+            if (!job.result.ok) {
+                std::cout << "  " << job.path << ": " << job.result.error << '\n';
+                continue;
+            }
+            std::cout << std::setw(12) << job.result.stats.parse_time_ms
+                      << std::setw(12) << job.result.solve_ms
+                      << std::setw(12) << job.wall_ms
+                      << std::setw(12) << job.result.stats.line_count
+                      << "  " << join_answers(job) << '\n';
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool sequential = false;
+    size_t thread_count = 0;
+    std::vector<std::pair<int, std::string>> selected;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--sequential") == 0) {
+            sequential = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            thread_count = std::strtoull(argv[++i], nullptr, 10);
+            continue;
+        }
+        const char* arg = argv[i];
+        const char* equals = std::strchr(arg, '=');
+        selected.emplace_back(std::atoi(arg), equals ? std::string(equals + 1) : std::string());
+    }
+    threading::StealingPool::set_shared_thread_count(thread_count);
+    if (selected.empty()) {
+        for (const auto& solver : registry::solvers()) selected.emplace_back(solver.day, std::string());
+    }
+
+    std::vector<Job> jobs;
+    int status = 0;
+    for (auto& [day, path] : selected) {
+        const registry::Solver* solver = registry::find(day);
+        if (solver == nullptr) {
+            std::cerr << "No solver registered for day " << day << '\n';
+            status = 1;
+            continue;
+        }
+        if (path.empty()) {
+            path = std::string(AOC_DATA_DIR) + "/" + std::to_string(day) + "/data.txt";
+        }
+        jobs.push_back({solver, path, {}, 0.0});
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    if (sequential || jobs.size() <= 1) {
+        for (Job& job : jobs) run_job(job);
+    } else {
+        // days run as tasks on the same pool their own parallel loops use, so --threads bounds the whole run
+        threading::parallel_for(0, jobs.size(), 1, [&jobs](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) run_job(jobs[i]);
+        });
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    double sum_ms = 0.0;
+    for (const Job& job : jobs) {
+        sum_ms += job.wall_ms;
+        if (!job.result.ok) status = 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    print_table(jobs);
+    std::cout << "wall: " << std::chrono::duration<double, std::milli>(end - start).count() << " ms"
+              << " (sum of days: " << sum_ms << " ms, " << (sequential ? "sequential" : "concurrent") << ")\n";
+    return status;
+}
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "1/solution.hpp"
+#include "2/solution.hpp"
+#include "3/solution.hpp"
+#include "4/solution.hpp"
+#include "5/solution.hpp"
+
+// Per-day parse/solve benchmark. Calls each day's parse() and solve() directly and reports both phases separately.
+// usage: bench [--runs N] [day | day=path]...   (default: every day on its own data.txt)
+
+#ifndef AOC_DATA_DIR
+#define AOC_DATA_DIR "."
+#endif
+
+namespace {
+
+    struct Sample {
+        fast_io::ReadStats stats;
+        double parse_ns = 0.0;
+        double solve_ns = 0.0;
+    };
+
+    using RunFn = std::optional<Sample> (*)(const char* path);
+
+    struct DayEntry {
+        int day;
+        RunFn run;
+    };
+
+    // Keep the answer alive so the solve call cannot be optimised away.
+    template<typename T>
+    void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    template<typename Input, typename Parse, typename Solve>
+    std::optional<Sample> run_day(const char* path, Parse parse, Solve solve) {
+        using clock = std::chrono::steady_clock;
+        Sample sample;
+        Input input;
+
+        const auto parse_start = clock::now();
+        const auto stats = parse(path, input, false);
+        const auto parse_end = clock::now();
+        if (!stats) return std::nullopt;
+
+        const auto answer = solve(input);
+        const auto solve_end = clock::now();
+        keep(answer);
+
+        sample.stats = *stats;
+        sample.parse_ns = std::chrono::duration<double, std::nano>(parse_end - parse_start).count();
+        sample.solve_ns = std::chrono::duration<double, std::nano>(solve_end - parse_end).count();
+        return sample;
+    }
+
+    const DayEntry DAYS[] = {
+        {1, [](const char* path) { return run_day<day1::Input>(path, day1::parse, [](const day1::Input& input) { return day1::solve(input); }); }},
+        {2, [](const char* path) { return run_day<day2::Input>(path, day2::parse, [](const day2::Input& input) { return day2::solve(input); }); }},
+        {3, [](const char* path) { return run_day<day3::Input>(path, day3::parse, [](const day3::Input& input) { return day3::solve(input); }); }},
+        {4, [](const char* path) { return run_day<day4::Input>(path, day4::parse, [](const day4::Input& input) { return day4::solve(input); }); }},
+        {5, [](const char* path) { return run_day<day5::Input>(path, day5::parse, [](const day5::Input& input) { return day5::solve(input); }); }},
+    };
+
+    // Best effort: ask the kernel to drop the file's cached pages so the first run reads from disk.
+    void evict_page_cache(const char* path) {
+#ifndef _WIN32
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return;
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+#else
+        (void)path;
+#endif
+    }
+
+    double percentile(std::vector<double> values, double fraction) {
+        std::sort(values.begin(), values.end());
+        const size_t rank = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+        return values[std::min(rank, values.size() - 1)];
+    }
+
+    void print_phase(int day, const char* phase, double cold_ns, const std::vector<double>& warm_ns,
+                     const fast_io::ReadStats& stats) {
+        const double median = percentile(warm_ns, 0.5);
+        const double lines = static_cast<double>(std::max<size_t>(1, stats.line_count));
+        const double megabytes = static_cast<double>(stats.file_size) / 1e6;
+
+        std::cout << std::setw(3) << day << "  " << std::setw(5) << phase
+                  << std::setw(12) << cold_ns / 1e6
+                  << std::setw(12) << percentile(warm_ns, 0.0) / 1e6
+                  << std::setw(12) << median / 1e6
+                  << std::setw(12) << percentile(warm_ns, 0.99) / 1e6
+                  << std::setw(12) << median / lines
+                  << std::setw(12) << megabytes / (median / 1e9) << '\n';
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 10;
+    std::vector<std::pair<int, std::string>> selected;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::max(2, std::atoi(argv[++i]));
+            continue;
+        }
+        const char* arg = argv[i];
+        const char* equals = std::strchr(arg, '=');
+        const int day = std::atoi(arg);
+        selected.emplace_back(day, equals ? std::string(equals + 1) : std::string());
+    }
+    if (selected.empty()) {
+        for (const auto& entry : DAYS) selected.emplace_back(entry.day, std::string());
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "runs: " << runs << " (first is cold, statistics over the rest)\n";
+    std::cout << "day  phase     cold_ms      min_ms   median_ms      p99_ms     ns/line        MB/s\n";
+
+    int status = 0;
+    for (auto& [day, path] : selected) {
+        const auto entry = std::find_if(std::begin(DAYS), std::end(DAYS), [&](const DayEntry& e) { return e.day == day; });
+        if (entry == std::end(DAYS)) {
+            std::cerr << "No solver registered for day " << day << '\n';
+            status = 1;
+            continue;
+        }
+        if (path.empty()) {
+            path = std::string(AOC_DATA_DIR) + "/" + std::to_string(day) + "/data.txt";
+        }
+
+        evict_page_cache(path.c_str());
+        std::vector<Sample> samples;
+        for (int r = 0; r < runs; ++r) {
+            auto sample = entry->run(path.c_str());
+            if (!sample) break;
+            samples.push_back(*sample);
+        }
+        if (samples.size() != static_cast<size_t>(runs)) {
+            std::cerr << "Can't open file: " << path << '\n';
+            status = 1;
+            continue;
+        }
+
+        std::vector<double> parse_ns;
+        std::vector<double> solve_ns;
+        for (size_t r = 1; r < samples.size(); ++r) {
+            parse_ns.push_back(samples[r].parse_ns);
+            solve_ns.push_back(samples[r].solve_ns);
+        }
+        print_phase(day, "parse", samples[0].parse_ns, parse_ns, samples[0].stats);
+        print_phase(day, "solve", samples[0].solve_ns, solve_ns, samples[0].stats);
+    }
+
+    return status;
+}
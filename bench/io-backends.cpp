@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "fast-io.hpp"
+
+// Load + line split time of every fast_io I/O backend, cold (page cache dropped first) and warm.
+// usage: bench_io <file> [runs]
+// The best row is what FAST_IO_BACKEND should be set to on this machine.
+
+namespace {
+
+    struct LineCount {
+        size_t lines = 0;
+        size_t bytes = 0;
+
+        void operator()(const char*, size_t len) {
+            ++lines;
+            bytes += len;
+        }
+    };
+
+    // Best effort: ask the kernel to drop the file's cached pages so the next read goes to the device.
+    void evict_page_cache(const char* path) {
+#ifndef _WIN32
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return;
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+#else
+        (void)path;
+#endif
+    }
+
+    struct Run {
+        double ms = 0.0;
+        fast_io::ReadStats stats;
+        LineCount count;
+    };
+
+    std::optional<Run> run_once(const char* path, const fast_io::IoOptions& io) {
+        Run run;
+        const auto start = std::chrono::steady_clock::now();
+        const auto stats = fast_io::read_lines(path, run.count, false, io);
+        const auto stop = std::chrono::steady_clock::now();
+        if (!stats) return std::nullopt;
+        run.stats = *stats;
+        run.ms = std::chrono::duration<double, std::milli>(stop - start).count();
+        return run;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: bench_io <file> [runs]\n";
+        return 1;
+    }
+    const char* path = argv[1];
+    const int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+    const char* variants[] = {"mmap", "mmap-populate", "mmap-huge", "pread", "direct", "io_uring"};
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "variant         used        cold_ms   warm_min_ms   warm_med_ms    warm_GB/s\n";
+
+    size_t expected_lines = 0;
+    bool first = true;
+    for (const char* variant : variants) {
+        fast_io::IoOptions io;
+        fast_io::parse_io_options(variant, io);
+
+        evict_page_cache(path);
+        const auto cold = run_once(path, io);
+        if (!cold) {
+            std::cerr << "Can't open file: " << path << '\n';
+            return 1;
+        }
+
+        std::vector<double> warm_ms;
+        for (int r = 0; r < runs; ++r) {
+            const auto warm = run_once(path, io);
+            if (!warm) return 1;
+            warm_ms.push_back(warm->ms);
+        }
+        std::sort(warm_ms.begin(), warm_ms.end());
+
+        if (first) expected_lines = cold->count.lines;
+        first = false;
+        if (cold->count.lines != expected_lines) {
+            std::cerr << "Mismatch: " << variant << " saw " << cold->count.lines << " lines, expected "
+                      << expected_lines << '\n';
+            return 1;
+        }
+
+        const double gigabytes = static_cast<double>(cold->stats.file_size) / 1e9;
+        const double median = warm_ms[warm_ms.size() / 2];
+        std::cout << std::left << std::setw(16) << variant << std::setw(10) << fast_io::to_string(cold->stats.backend)
+                  << std::right << std::setw(11) << cold->ms
+                  << std::setw(14) << warm_ms.front()
+                  << std::setw(14) << median
+                  << std::setw(13) << gigabytes / (median / 1e3) << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fast-io.hpp"
+
+// Integer parsing throughput: the old digit-at-a-time loop, std::from_chars and fast_io::parse_number.
+// usage: bench_parse [count] [repetitions]
+
+namespace {
+
+    struct Token {
+        const char* start;
+        size_t len;
+    };
+
+    // The loop fast_io::parse_int and the day parsers used before: one digit per step, non-digits skipped.
+    uint64_t parse_loop(const char* start, size_t len) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < len; ++i) {
+            const char c = start[i];
+            if (c >= '0' && c <= '9') value = value * 10 + (c - '0');
+        }
+        return value;
+    }
+
+    // Newline separated numbers whose digit count is uniform in [min_digits, max_digits].
+    std::string make_input(size_t count, int min_digits, int max_digits, std::vector<Token>& tokens) {
+        std::mt19937_64 rng(2025);
+        std::uniform_int_distribution<int> digits(min_digits, max_digits);
+        std::uniform_int_distribution<int> digit('0', '9');
+
+        std::string data;
+        std::vector<size_t> offsets;
+        for (size_t i = 0; i < count; ++i) {
+            offsets.push_back(data.size());
+            const int n = digits(rng);
+            data.push_back(static_cast<char>(std::uniform_int_distribution<int>('1', '9')(rng)));
+            for (int d = 1; d < n; ++d) data.push_back(static_cast<char>(digit(rng)));
+            data.push_back('\n');
+        }
+
+        tokens.clear();
+        for (size_t i = 0; i < count; ++i) {
+            const size_t end = (i + 1 < count ? offsets[i + 1] : data.size()) - 1;
+            tokens.push_back({data.data() + offsets[i], end - offsets[i]});
+        }
+        return data;
+    }
+
+    template<typename Parse>
+    double best_seconds(int repetitions, const std::vector<Token>& tokens, uint64_t& checksum, Parse&& parse) {
+        double best = 1e300;
+        for (int r = 0; r < repetitions; ++r) {
+            uint64_t sum = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (const Token& token : tokens) sum += parse(token.start, token.len);
+            const auto stop = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(stop - start).count());
+            checksum = sum;
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 10'000'000;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    std::cout << "numbers: " << count << ", best of " << repetitions << " runs, Mnumbers/s\n";
+    std::cout << "digits\tloop\tfrom_chars\tparse_number\n";
+
+    bool all_match = true;
+    const std::pair<int, int> digit_ranges[] = {{1, 4}, {1, 8}, {8, 12}, {12, 19}, {1, 19}};
+    for (const auto& [min_digits, max_digits] : digit_ranges) {
+        std::vector<Token> tokens;
+        const std::string input = make_input(count, min_digits, max_digits, tokens);
+
+        uint64_t loop_sum = 0;
+        uint64_t from_chars_sum = 0;
+        uint64_t fast_sum = 0;
+        const double loop_seconds = best_seconds(repetitions, tokens, loop_sum, parse_loop);
+        const double from_chars_seconds = best_seconds(repetitions, tokens, from_chars_sum, [](const char* start, size_t len) {
+            uint64_t value = 0;
+            std::from_chars(start, start + len, value);
+            return value;
+        });
+        const double fast_seconds = best_seconds(repetitions, tokens, fast_sum, [](const char* start, size_t len) {
+            return fast_io::parse_number<uint64_t>(start, len).value;
+        });
+
+        const bool match = loop_sum == from_chars_sum && fast_sum == from_chars_sum;
+        all_match = all_match && match;
+
+        const double millions = static_cast<double>(count) / 1e6;
+        std::cout << min_digits << "-" << max_digits
+                  << '\t' << millions / loop_seconds
+                  << '\t' << millions / from_chars_seconds
+                  << '\t' << millions / fast_seconds
+                  << (match ? "" : "\tMISMATCH") << '\n';
+    }
+
+    return all_match ? 0 : 1;
+}
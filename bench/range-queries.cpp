@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "5/solution.hpp"
+
+// Query throughput of the day 5 membership strategies over merged id ranges of growing size.
+// usage: bench_ranges [queries] [repetitions]
+
+namespace {
+
+    using day5::Inventory::IdRange;
+    using day5::Inventory::IdSet;
+    using day5::Inventory::IdType;
+
+    // Random ranges over a space wide enough that roughly half of the queries land inside one after merging.
+    std::vector<IdRange> make_ranges(size_t count, std::mt19937_64& rng) {
+        const IdType max_id = static_cast<IdType>(count) * 1'000'000;
+        std::uniform_int_distribution<IdType> first(1, max_id);
+        std::uniform_int_distribution<IdType> span(0, 1'000'000);
+
+        std::vector<IdRange> ranges(count);
+        for (auto& range : ranges) {
+            range.first = first(rng);
+            range.last = range.first + span(rng);
+        }
+        std::sort(ranges.begin(), ranges.end());
+        IdSet merged;
+        merged.assign_sorted(ranges.begin(), ranges.end());
+        return merged.to_vector();
+    }
+
+    std::vector<IdType> make_ids(size_t count, IdType max_id, std::mt19937_64& rng) {
+        std::uniform_int_distribution<IdType> id(1, max_id);
+        std::vector<IdType> ids(count);
+        for (auto& value : ids) value = id(rng);
+        return ids;
+    }
+
+    template<typename Count>
+    double best_seconds(int repetitions, size_t& result, Count&& count) {
+        double best = 1e300;
+        for (int r = 0; r < repetitions; ++r) {
+            const auto start = std::chrono::steady_clock::now();
+            result = count();
+            const auto stop = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(stop - start).count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t queries = argc > 1 ? std::stoul(argv[1]) : 4'000'000;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    std::cout << "queries: " << queries << ", best of " << repetitions << " runs, Mqueries/s\n";
+    std::cout << "ranges\tupper_bound\teytzinger\tsweep\n";
+
+    std::mt19937_64 rng(2025);
+    bool all_match = true;
+
+    for (const size_t range_count : {1'000ul, 64'000ul, 1'000'000ul, 4'000'000ul}) {
+        const std::vector<IdRange> merged = make_ranges(range_count, rng);
+        const std::vector<IdType> ids = make_ids(queries, merged.back().last, rng);
+        const day5::Inventory::RangeIndex index(merged);
+
+        size_t reference = 0;
+        size_t eytzinger = 0;
+        size_t sweep = 0;
+        const double binary_seconds = best_seconds(repetitions, reference, [&] {
+            return day5::Inventory::count_fresh_binary_search(merged, ids);
+        });
+        const double eytzinger_seconds = best_seconds(repetitions, eytzinger, [&] {
+            return index.count_contained(ids);
+        });
+        const double sweep_seconds = best_seconds(repetitions, sweep, [&] {
+            return day5::Inventory::count_fresh_sweep(merged, ids);
+        });
+
+        const bool match = eytzinger == reference && sweep == reference;
+        all_match = all_match && match;
+
+        const double millions = static_cast<double>(queries) / 1e6;
+        std::cout << merged.size()
+                  << '\t' << millions / binary_seconds
+                  << '\t' << millions / eytzinger_seconds
+                  << '\t' << millions / sweep_seconds
+                  << (match ? "" : "\tMISMATCH vs upper_bound") << '\n';
+    }
+
+    return all_match ? 0 : 1;
+}
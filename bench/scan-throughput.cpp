@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fast-io.hpp"
+
+// Throughput of fast_io::for_each_line / for_each_token for every SIMD level the CPU supports.
+// usage: bench_scan [size_mb] [repetitions]
+
+namespace {
+
+    struct Checksum {
+        size_t count = 0;
+        size_t bytes = 0;
+        uint64_t hash = 0;
+
+        void operator()(const char* start, size_t len) {
+            ++count;
+            bytes += len;
+            hash = hash * 31 + static_cast<unsigned char>(start[0]) + len;
+        }
+
+        bool operator==(const Checksum&) const = default;
+    };
+
+    // Mix of short AoC-style records, a few long lines, CRLF endings and blank lines.
+    std::string make_input(size_t size_bytes) {
+        std::mt19937_64 rng(2025);
+        std::uniform_int_distribution<int> kind(0, 99);
+        std::uniform_int_distribution<int> digit('0', '9');
+        std::uniform_int_distribution<int> short_len(2, 16);
+        std::uniform_int_distribution<int> long_len(64, 400);
+
+        std::string data;
+        data.reserve(size_bytes + 512);
+        while (data.size() < size_bytes) {
+            const int k = kind(rng);
+            const int len = k < 90 ? short_len(rng) : long_len(rng);
+            for (int i = 0; i < len; ++i) {
+                data.push_back(i % 12 == 11 ? ',' : static_cast<char>(digit(rng)));
+            }
+            if (k % 10 == 0) data += "\r\n";
+            else if (k % 17 == 0) data += "\n\n";
+            else data.push_back('\n');
+        }
+        return data;
+    }
+
+    template<typename Split>
+    double best_seconds(int repetitions, Checksum& result, Split&& split) {
+        double best = 1e300;
+        for (int r = 0; r < repetitions; ++r) {
+            Checksum checksum;
+            const auto start = std::chrono::steady_clock::now();
+            split(checksum);
+            const auto stop = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(stop - start).count());
+            result = checksum;
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t size_mb = argc > 1 ? std::stoul(argv[1]) : 256;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    const std::string input = make_input(size_mb * 1024 * 1024);
+    const char* begin = input.data();
+    const char* end = input.data() + input.size();
+    const double gigabytes = static_cast<double>(input.size()) / 1e9;
+
+    std::cout << "input: " << input.size() << " bytes, best of " << repetitions << " runs\n";
+    std::cout << "supported: " << fast_io::to_string(fast_io::supported_simd_level()) << "\n\n";
+
+    Checksum reference_lines;
+    Checksum reference_tokens;
+    bool all_match = true;
+
+    for (int level = 0; level <= static_cast<int>(fast_io::supported_simd_level()); ++level) {
+        const auto simd = fast_io::set_simd_level(static_cast<fast_io::SimdLevel>(level));
+
+        Checksum lines;
+        const double line_seconds = best_seconds(repetitions, lines, [&](Checksum& checksum) {
+            fast_io::for_each_line(begin, end, checksum);
+        });
+        Checksum tokens;
+        const double token_seconds = best_seconds(repetitions, tokens, [&](Checksum& checksum) {
+            fast_io::for_each_token(begin, end, ',', checksum);
+        });
+
+        if (simd == fast_io::SimdLevel::Scalar) {
+            reference_lines = lines;
+            reference_tokens = tokens;
+        }
+        const bool match = lines == reference_lines && tokens == reference_tokens;
+        all_match = all_match && match;
+
+        std::cout << fast_io::to_string(simd) << "\tlines: " << gigabytes / line_seconds << " GB/s"
+                  << "\ttokens: " << gigabytes / token_seconds << " GB/s"
+                  << "\t(" << lines.count << " lines, " << tokens.count << " tokens)"
+                  << (match ? "" : "\tMISMATCH vs scalar") << '\n';
+    }
+
+    fast_io::set_simd_level(fast_io::supported_simd_level());
+    return all_match ? 0 : 1;
+}
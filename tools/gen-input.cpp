@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+
+// Seeded generator for large, valid puzzle inputs, used to drive scale testing of the day solvers.
+// usage: gen_input <day> <output|-> [seed=N] [key=value]...
+//   day 1: lines=1000000 max_rotation=999
+//   day 2: ranges=1000 max_digits=10 max_span=1000000000
+//   day 3: banks=1000000 width=100 zero_banks=0.01
+//   day 4: width=1000 height=1000 density=0.6
+//   day 5: ranges=1000000 ids=1000000 max_id=1000000000000 max_span=10000000
+
+namespace {
+
+    class Output {
+    public:
+        explicit Output(FILE* file) : file_(file) {
+            buffer_.reserve(BUFFER_SIZE + 128);
+        }
+
+        ~Output() { flush(); }
+
+        void put(char c) {
+            buffer_.push_back(c);
+            if (buffer_.size() >= BUFFER_SIZE) flush();
+        }
+
+        void put(uint64_t value) {
+            char digits[20];
+            int count = 0;
+            do {
+                digits[count++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+            while (count > 0) put(digits[--count]);
+        }
+
+        void flush() {
+            if (!buffer_.empty()) std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+            buffer_.clear();
+        }
+
+    private:
+        static constexpr size_t BUFFER_SIZE = 1024 * 1024;
+        FILE* file_;
+        std::string buffer_;
+    };
+
+    class Params {
+    public:
+        bool parse(int argc, char* argv[], int first) {
+            for (int i = first; i < argc; ++i) {
+                const char* equals = std::strchr(argv[i], '=');
+                if (!equals) return false;
+                values_[std::string(argv[i], static_cast<size_t>(equals - argv[i]))] = equals + 1;
+            }
+            return true;
+        }
+
+        uint64_t get(const char* key, uint64_t fallback) const {
+            const auto it = values_.find(key);
+            return it == values_.end() ? fallback : std::strtoull(it->second.c_str(), nullptr, 10);
+        }
+
+        double get_double(const char* key, double fallback) const {
+            const auto it = values_.find(key);
+            return it == values_.end() ? fallback : std::strtod(it->second.c_str(), nullptr);
+        }
+
+    private:
+        std::map<std::string, std::string> values_;
+    };
+
+    uint64_t pow10(uint64_t exponent) {
+        uint64_t value = 1;
+        while (exponent-- > 0) value *= 10;
+        return value;
+    }
+
+    // R/L rotations, one per line.
+    void generate_day1(Output& out, std::mt19937_64& rng, const Params& params) {
+        const uint64_t lines = params.get("lines", 1'000'000);
+        std::uniform_int_distribution<uint64_t> rotation(1, params.get("max_rotation", 999));
+        for (uint64_t i = 0; i < lines; ++i) {
+            out.put((rng() & 1) ? 'R' : 'L');
+            out.put(rotation(rng));
+            out.put('\n');
+        }
+    }
+
+    // Comma separated first-last id ranges, wrapped like the puzzle input. Spans vary over many orders of magnitude.
+    void generate_day2(Output& out, std::mt19937_64& rng, const Params& params) {
+        const uint64_t ranges = params.get("ranges", 1000);
+        const uint64_t max_digits = std::min<uint64_t>(19, params.get("max_digits", 10));
+        const uint64_t max_span = params.get("max_span", 1'000'000'000);
+        std::uniform_int_distribution<uint64_t> digits(1, max_digits);
+        uint64_t max_span_digits = 1;  // floor(log10(max_span)), at least 1; counted exactly, max_span may be 0
+        for (uint64_t rest = max_span; rest >= 100; rest /= 10) ++max_span_digits;
+
+        for (uint64_t i = 0; i < ranges; ++i) {
+            const uint64_t d = digits(rng);
+            const uint64_t first = std::uniform_int_distribution<uint64_t>(pow10(d - 1), pow10(d) - 1)(rng);
+            const uint64_t span_digits = std::uniform_int_distribution<uint64_t>(0, max_span_digits)(rng);
+            const uint64_t span = std::uniform_int_distribution<uint64_t>(0, std::min(max_span, pow10(span_digits)))(rng);
+            const uint64_t last = first + std::min(span, UINT64_MAX - first);
+
+            out.put(first);
+            out.put('-');
+            out.put(last);
+            if (i + 1 < ranges) out.put(',');
+            if (i % 8 == 7 || i + 1 == ranges) out.put('\n');
+        }
+    }
+
+    // Banks of digits 1-9, all the same width. A zero_banks share of them is three digits followed by zeros, so
+    // the greedy also sees windows with nothing but zeros in them.
+    void generate_day3(Output& out, std::mt19937_64& rng, const Params& params) {
+        const uint64_t banks = params.get("banks", 1'000'000);
+        const uint64_t width = std::max<uint64_t>(12, params.get("width", 100));
+        std::uniform_int_distribution<int> digit(1, 9);
+        std::bernoulli_distribution zero_bank(params.get_double("zero_banks", 0.01));
+        for (uint64_t i = 0; i < banks; ++i) {
+            const uint64_t nonzero = zero_bank(rng) ? 3 : width;
+            for (uint64_t j = 0; j < width; ++j) out.put(static_cast<char>(j < nonzero ? '0' + digit(rng) : '0'));
+            out.put('\n');
+        }
+    }
+
+    // '@' rolls with the given density on a '.' background.
+    void generate_day4(Output& out, std::mt19937_64& rng, const Params& params) {
+        const uint64_t width = params.get("width", 1000);
+        const uint64_t height = params.get("height", 1000);
+        std::bernoulli_distribution roll(params.get_double("density", 0.6));
+        for (uint64_t y = 0; y < height; ++y) {
+            for (uint64_t x = 0; x < width; ++x) out.put(roll(rng) ? '@' : '.');
+            out.put('\n');
+        }
+    }
+
+    // Overlapping first-last ranges, a blank line, then ids to query.
+    void generate_day5(Output& out, std::mt19937_64& rng, const Params& params) {
+        const uint64_t ranges = params.get("ranges", 1'000'000);
+        const uint64_t ids = params.get("ids", 1'000'000);
+        const uint64_t max_id = std::max<uint64_t>(2, params.get("max_id", 1'000'000'000'000));
+        const uint64_t max_span = params.get("max_span", 10'000'000);
+        std::uniform_int_distribution<uint64_t> id(1, max_id);
+        std::uniform_int_distribution<uint64_t> span(0, max_span);
+
+        for (uint64_t i = 0; i < ranges; ++i) {
+            const uint64_t first = id(rng);
+            out.put(first);
+            out.put('-');
+            out.put(first + span(rng));
+            out.put('\n');
+        }
+        out.put('\n');
+        for (uint64_t i = 0; i < ids; ++i) {
+            out.put(id(rng));
+            out.put('\n');
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Params params;
+    if (argc < 3 || !params.parse(argc, argv, 3)) {
+        std::cerr << "usage: gen_input <day> <output|-> [seed=N] [key=value]...\n";
+        return 1;
+    }
+
+    const int day = std::atoi(argv[1]);
+    const char* path = argv[2];
+
+    FILE* file = std::strcmp(path, "-") == 0 ? stdout : std::fopen(path, "wb");
+    if (!file) {
+        std::cerr << "Can't open file: " << path << '\n';
+        return 1;
+    }
+
+    std::mt19937_64 rng(params.get("seed", 2025));
+    {
+        Output out(file);
+        switch (day) {
+            case 1: generate_day1(out, rng, params); break;
+            case 2: generate_day2(out, rng, params); break;
+            case 3: generate_day3(out, rng, params); break;
+            case 4: generate_day4(out, rng, params); break;
+            case 5: generate_day5(out, rng, params); break;
+            default:
+                std::cerr << "No generator for day " << day << '\n';
+                return 1;
+        }
+    }
+
+    if (file != stdout) std::fclose(file);
+    return 0;
+}
@@ -0,0 +1,195 @@
+#ifndef UTILS_BATCH_RUNNER_HPP
+#define UTILS_BATCH_RUNNER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fast-io.hpp"
+#include "thread-pool.hpp"
+
+//runs a day's parse/solve over many input files on the shared work-stealing pool. Used by the day mains with --batch.
+namespace batch {
+
+struct Options {
+    size_t thread_count = 0;                     // 0 = std::thread::hardware_concurrency()
+    size_t max_inflight_bytes = size_t{1} << 30; // input bytes being parsed/solved at the same time
+};
+
+// One row of the batch output.
+struct FileResult {
+    bool ok = false;
+    std::string error = "can't open file";  // when not ok
+    std::vector<std::string> answers;
+    fast_io::ReadStats stats;
+    double solve_ms = 0.0;
+};
+
+// Handles the batch options of a day main at argv[i]: --threads N and --max-inflight-mb N.
+// Returns false if argv[i] is not one of them; consumes the value otherwise.
+inline bool parse_option(int argc, char* argv[], int& i, Options& options) {
+    if (i + 1 >= argc) return false;
+    if (std::strcmp(argv[i], "--threads") == 0) {
+        options.thread_count = std::strtoull(argv[++i], nullptr, 10);
+        return true;
+    }
+    if (std::strcmp(argv[i], "--max-inflight-mb") == 0) {
+        options.max_inflight_bytes = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10)) << 20;
+        return true;
+    }
+    return false;
+}
+
+// Expands the batch sources into input files, in order:
+//   a directory     its regular files, sorted by name
+//   @manifest       one path per line; blank lines and lines starting with '#' are skipped
+//   anything else   taken as a file
+inline bool collect_inputs(const std::vector<std::string>& sources, std::vector<std::string>& files) {
+    namespace fs = std::filesystem;
+
+    for (const std::string& source : sources) {
+        if (!source.empty() && source[0] == '@') {
+            std::ifstream manifest(source.substr(1));
+            if (!manifest) {
+                std::cerr << "Can't open manifest: " << source.substr(1) << std::endl;
+                return false;
+            }
+            std::string line;
+            while (std::getline(manifest, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (line.empty() || line[0] == '#') continue;
+                files.push_back(line);
+            }
+            continue;
+        }
+
+        std::error_code error;
+        if (fs::is_directory(source, error)) {
+            std::vector<std::string> entries;
+            for (const auto& entry : fs::directory_iterator(source, error)) {
+                if (entry.is_regular_file(error)) entries.push_back(entry.path().string());
+            }
+            if (error) {
+                std::cerr << "Can't read directory: " << source << std::endl;
+                return false;
+            }
+            std::sort(entries.begin(), entries.end());
+            files.insert(files.end(), entries.begin(), entries.end());
+            continue;
+        }
+
+        files.push_back(source);
+    }
+    return true;
+}
+
+// Parses and solves one file, timing both phases. to_answers(answer) gives the answer columns; validate(input,
+// answer) returns an error message, empty if the file is fine, which fails the row.
+template<typename Input, typename Parse, typename Solve, typename ToAnswers, typename Validate>
+FileResult solve_file(const char* path, Parse&& parse, Solve&& solve, ToAnswers&& to_answers, Validate&& validate) {
+    FileResult result;
+    Input input;
+    const auto stats = parse(path, input, false);
+    if (!stats) return result;
+
+    const auto solve_start = std::chrono::steady_clock::now();
+    const auto answer = solve(input);
+    const auto solve_end = std::chrono::steady_clock::now();
+
+    result.error = validate(input, answer);
+    result.ok = result.error.empty();
+    result.stats = *stats;
+    result.solve_ms = std::chrono::duration<double, std::milli>(solve_end - solve_start).count();
+    result.answers = to_answers(answer);
+    return result;
+}
+
+template<typename Input, typename Parse, typename Solve, typename ToAnswers>
+FileResult solve_file(const char* path, Parse&& parse, Solve&& solve, ToAnswers&& to_answers) {
+    return solve_file<Input>(path, std::forward<Parse>(parse), std::forward<Solve>(solve),
+                             std::forward<ToAnswers>(to_answers), [](const Input&, const auto&) { return std::string(); });
+}
+
+namespace detail {
+    inline void print_header(std::ostream& out, const std::vector<std::string>& answer_names) {
+        out << "file";
+        for (const std::string& name : answer_names) out << '\t' << name;
+        out << "\tbytes\tlines\tparse_ms\tsolve_ms\n";
+    }
+
+    inline void print_row(std::ostream& out, const std::string& file, const FileResult& result) {
+        out << file;
+        if (!result.ok) {
+            out << "\terror: " << result.error << '\n';
+            return;
+        }
+        for (const std::string& answer : result.answers) out << '\t' << answer;
+        out << '\t' << result.stats.file_size << '\t' << result.stats.line_count
+            << '\t' << result.stats.parse_time_ms << '\t' << result.solve_ms << '\n';
+    }
+
+    // Budget charged for a file while it is in flight. Parsed inputs are roughly proportional to the file, so the
+    // file size stands in for the memory it needs. Capped at the budget, so an oversized file runs on its own.
+    inline size_t inflight_cost(const std::string& file, const Options& options) {
+        std::error_code error;
+        const auto size = std::filesystem::file_size(file, error);
+        const size_t cost = error ? 1 : std::max<size_t>(1, static_cast<size_t>(size));
+        return std::min(cost, options.max_inflight_bytes);
+    }
+}
+
+// Solves every file with solve_file(const char* path) -> FileResult and prints one tab separated row per file, in
+// input order. Files run in waves on the shared work-stealing pool, so --threads bounds the files and their own
+// parallel loops together: each wave takes the next files in order while the in-flight budget allows (at least
+// one), which keeps memory bounded however many files there are. Returns the exit code: 1 if any file failed.
+template<typename SolveFile>
+int run(const std::vector<std::string>& files, const std::vector<std::string>& answer_names, SolveFile&& solve_file,
+        const Options& options = {}, std::ostream& out = std::cout) {
+    const auto start_time = std::chrono::steady_clock::now();
+    threading::StealingPool::set_shared_thread_count(options.thread_count);
+
+    std::vector<FileResult> results;
+    size_t failed = 0;
+
+    detail::print_header(out, answer_names);
+
+    for (size_t first = 0; first < files.size();) {
+        size_t last = first;
+        for (size_t inflight_bytes = 0; last < files.size(); ++last) {
+            const size_t cost = detail::inflight_cost(files[last], options);
+            if (inflight_bytes != 0 && inflight_bytes + cost > options.max_inflight_bytes) break;
+            inflight_bytes += cost;
+        }
+
+        results.assign(last - first, FileResult{});
+        threading::parallel_for(first, last, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) results[i - first] = solve_file(files[i].c_str());
+        });
+
+        for (size_t i = first; i < last; ++i) {
+            detail::print_row(out, files[i], results[i - first]);
+            failed += !results[i - first].ok;
+        }
+        out.flush();
+        first = last;
+    }
+
+    const auto end_time = std::chrono::steady_clock::now();
+    out << "# files: " << files.size() << ", failed: " << failed
+        << ", threads: " << threading::StealingPool::instance().size() + 1
+        << ", wall: " << std::chrono::duration<double, std::milli>(end_time - start_time).count() << " ms\n";
+    out.flush();
+    return failed == 0 ? 0 : 1;
+}
+
+}  // namespace batch
+
+#endif
@@ -1,21 +1,28 @@
 #ifndef UTILS_FAST_IO_HPP
 #define UTILS_FAST_IO_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "instrument.hpp"
+#include "io-backend.hpp"
+#include "line-scan.hpp"
+#include "parse-int.hpp"
+#include "record-format.hpp"
+#include "stream-reader.hpp"
+#include "thread-pool.hpp"
 
-#ifdef _WIN32
-    #define WIN32_LEAN_AND_MEAN
-    #define NOMINMAX
-    #include <windows.h>
-#else
-    #include <sys/mman.h>
-    #include <sys/stat.h>
-    #include <fcntl.h>
-    #include <unistd.h>
-#endif
 
 //utility for reading input files. General purpose. Not part of the solutions as such.
 namespace fast_io {
@@ -23,118 +30,339 @@ namespace fast_io {
 struct ReadStats {
     size_t file_size = 0;
     size_t line_count = 0;
+    size_t section_count = 0;   // read_sections and read_indexed only
+    IoBackend backend = IoBackend::Mmap;  // the one that loaded a regular file, after fallbacks
     double parse_time_ms = 0.0;
 };
 
 namespace detail {
-    struct MappedFile {
-        const char* data = nullptr;
-        size_t size = 0;
+    // Reference byte-at-a-time splitters. Used when no SIMD kernel is available and as the baseline for benchmarks.
+    template<typename LineParser>
+    size_t split_lines_scalar(const char* ptr, const char* end, LineParser& parser) {
+        size_t line_count = 0;
+        const char* line_start = ptr;
+
+        while (ptr < end) {
+            if (*ptr == '\n' || *ptr == '\r') {
+                size_t line_len = ptr - line_start;
+                if (line_len > 0) {
+                    parser(line_start, line_len);
+                    ++line_count;
+                }
+
+                if (ptr + 1 < end && (ptr[1] == '\n' || ptr[1] == '\r') && ptr[0] != ptr[1]) {
+                    ++ptr;
+                }
+                line_start = ptr + 1;
+            }
+            ++ptr;
+        }
+
+        if (line_start < end) {
+            parser(line_start, end - line_start);
+            ++line_count;
+        }
+        return line_count;
+    }
+
+    template<typename TokenParser>
+    size_t split_delimited_scalar(const char* ptr, const char* end, char delimiter, TokenParser& parser) {
+        size_t token_count = 0;
+        const char* token_start = ptr;
+
+        while (ptr < end) {
+            if (*ptr == delimiter || *ptr == '\n' || *ptr == '\r') {
+                size_t token_len = ptr - token_start;
+                if (token_len > 0) {
+                    parser(token_start, token_len);
+                    ++token_count;
+                }
+
+                // Handle \r\n
+                if ((*ptr == '\r' || *ptr == '\n') && ptr + 1 < end &&
+                    (ptr[1] == '\n' || ptr[1] == '\r') && ptr[0] != ptr[1]) {
+                    ++ptr;
+                }
+                token_start = ptr + 1;
+            }
+            ++ptr;
+        }
+
+        // Final token without trailing delimiter/newline
+        if (token_start < end) {
+            parser(token_start, end - token_start);
+            ++token_count;
+        }
+        return token_count;
+    }
+
+    // Empty lines/tokens are dropped, so CRLF/LFCR pairs need no special casing here:
+    // the second byte of a pair just closes an empty token.
+    template<typename TokenParser>
+    size_t split_simd(const char* ptr, const char* end, char delimiter, TokenParser& parser) {
+        size_t token_count = 0;
+        const char* token_start = ptr;
+
+        scan_separators(ptr, end, delimiter, [&](const char* separator) {
+            if (separator > token_start) {
+                parser(token_start, static_cast<size_t>(separator - token_start));
+                ++token_count;
+            }
+            token_start = separator + 1;
+        });
+
+        if (token_start < end) {
+            parser(token_start, static_cast<size_t>(end - token_start));
+            ++token_count;
+        }
+        return token_count;
+    }
+}
+
+// Split an in-memory buffer into non-empty lines. Returns the number of lines handed to the parser.
+template<typename LineParser>
+size_t for_each_line(const char* begin, const char* end, LineParser&& parser) {
+    if (simd_level() == SimdLevel::Scalar) {
+        return detail::split_lines_scalar(begin, end, parser);
+    }
+    return detail::split_simd(begin, end, '\n', parser);
+}
 
-#ifdef _WIN32
-        HANDLE file_handle = INVALID_HANDLE_VALUE;
-        HANDLE mapping_handle = nullptr;
-#else
-        int fd = -1;
-#endif
+// Split an in-memory buffer on the delimiter and on line breaks. Returns the number of tokens handed to the parser.
+template<typename TokenParser>
+size_t for_each_token(const char* begin, const char* end, char delimiter, TokenParser&& parser) {
+    if (simd_level() == SimdLevel::Scalar) {
+        return detail::split_delimited_scalar(begin, end, delimiter, parser);
+    }
+    return detail::split_simd(begin, end, delimiter, parser);
+}
 
-        bool open(const char* path) {
-#ifdef _WIN32
-            file_handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ,
-                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-            if (file_handle == INVALID_HANDLE_VALUE) return false;
+namespace detail {
+    inline bool is_separator(char c, char delimiter) {
+        return c == delimiter || c == '\n' || c == '\r';
+    }
 
-            LARGE_INTEGER file_size;
-            if (!GetFileSizeEx(file_handle, &file_size)) { close(); return false; }
-            size = static_cast<size_t>(file_size.QuadPart);
+    template<typename TokenParser>
+    size_t split_block(const char* begin, const char* end, char delimiter, TokenParser& parser) {
+        return delimiter == '\n' ? for_each_line(begin, end, parser) : for_each_token(begin, end, delimiter, parser);
+    }
 
-            if (size == 0) return true;  // empty file is valid
+    // Split a stream block by block. Complete tokens are parsed in place; the unterminated tail of each block is
+    // carried over and completed from the next one, so only tokens spanning a block boundary are copied.
+    template<typename TokenParser>
+    std::optional<ReadStats> read_stream(const char* path, char delimiter, TokenParser& parser, bool debug) {
+        ReadStats stats;
 
-            mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
-            if (!mapping_handle) { close(); return false; }
+        InputStream input;
+        if (!input.open(path)) {
+            if (debug) std::cerr << "[fast_io] Failed to open: " << path << '\n';
+            return std::nullopt;
+        }
 
-            data = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
-            if (!data) { close(); return false; }
-#else
-            fd = ::open(path, O_RDONLY);
-            if (fd < 0) return false;
+        StreamReader reader(input);
+        StreamReader::Block block;
+        std::string carry;
+
+        while (reader.next(block)) {
+            const char* begin = block.data;
+            const char* end = block.data + block.size;
+            stats.file_size += block.size;
+
+            if (!carry.empty()) {
+                const char* separator = begin;
+                while (separator < end && !is_separator(*separator, delimiter)) ++separator;
+                carry.append(begin, separator);
+                if (separator == end) {
+                    reader.release();
+                    continue;
+                }
+                parser(carry.data(), carry.size());
+                ++stats.line_count;
+                carry.clear();
+                begin = separator;
+            }
 
-            struct stat st;
-            if (fstat(fd, &st) < 0) { close(); return false; }
-            size = static_cast<size_t>(st.st_size);
+            const char* tail = end;
+            while (tail > begin && !is_separator(tail[-1], delimiter)) --tail;
+            stats.line_count += split_block(begin, tail, delimiter, parser);
+            carry.assign(tail, end);
 
-            if (size == 0) return true;
+            reader.release();
+        }
 
-            data = static_cast<const char*>(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
-            if (data == MAP_FAILED) { data = nullptr; close(); return false; }
+        if (!carry.empty()) {
+            parser(carry.data(), carry.size());
+            ++stats.line_count;
+        }
 
-            // Hint to OS we'll read sequentially
-            madvise(const_cast<char*>(data), size, MADV_SEQUENTIAL);
-#endif
-            return true;
+        if (reader.failed()) {
+            if (debug) std::cerr << "[fast_io] Read error: " << path << '\n';
+            return std::nullopt;
         }
+        return stats;
+    }
+
+    inline bool load_file(LoadedFile& file, const char* path, const IoOptions& io) {
+        INSTRUMENT_SCOPE("load");
+        return is_mappable(path) && file.open(path, io);
+    }
 
-        void close() {
-#ifdef _WIN32
-            if (data) { UnmapViewOfFile(data); data = nullptr; }
-            if (mapping_handle) { CloseHandle(mapping_handle); mapping_handle = nullptr; }
-            if (file_handle != INVALID_HANDLE_VALUE) { CloseHandle(file_handle); file_handle = INVALID_HANDLE_VALUE; }
-#else
-            if (data && size > 0) { munmap(const_cast<char*>(data), size); data = nullptr; }
-            if (fd >= 0) { ::close(fd); fd = -1; }
-#endif
+    // Shared driver for read_lines / read_delimited: regular files are loaded with the I/O backend from io,
+    // everything else is streamed.
+    template<typename TokenParser>
+    std::optional<ReadStats> read_tokens(const char* path, char delimiter, TokenParser& parser, bool debug,
+                                         const char* count_label, const IoOptions& io = default_io_options()) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        std::optional<ReadStats> stats;
+
+        LoadedFile file;
+        if (load_file(file, path, io)) {
+            stats.emplace();
+            stats->file_size = file.size;
+            stats->backend = file.backend;
+            if (file.size == 0) {
+                if (debug) std::cout << "[fast_io] Empty file\n";
+                return stats;  // valid empty file
+            }
+            INSTRUMENT_SCOPE("split");
+            stats->line_count = split_block(file.data, file.data + file.size, delimiter, parser);
+        } else {
+            // Pipes, stdin, or files that could not be mapped (e.g. larger than the address space).
+            INSTRUMENT_SCOPE("stream");
+            stats = read_stream(path, delimiter, parser, debug);
+            if (!stats) return std::nullopt;
         }
 
-        ~MappedFile() { close(); }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        stats->parse_time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
 
-        MappedFile() = default;
-        MappedFile(const MappedFile&) = delete;
-        MappedFile& operator=(const MappedFile&) = delete;
-    };
+        if (debug) {
+            std::cout << "[fast_io] File: " << path << '\n'
+                      << "[fast_io] Size: " << stats->file_size << " bytes (" << to_string(stats->backend) << ")\n"
+                      << "[fast_io] " << count_label << ": " << stats->line_count << '\n'
+                      << "[fast_io] Time: " << stats->parse_time_ms << " ms\n";
+        }
+
+        return stats;
+    }
 }
 
 // Line parser must implement: void operator()(const char* line_start, size_t line_length)
+// Regular files are loaded with the backend from io (memory mapped by default); pipes, FIFOs and "-" (stdin) are read
+// through a double-buffered stream.
 template<typename LineParser>
-std::optional<ReadStats> read_lines(const char* path, LineParser&& parser, bool debug = false) {
+std::optional<ReadStats> read_lines(const char* path, LineParser&& parser, bool debug = false,
+                                    const IoOptions& io = default_io_options()) {
+    return detail::read_tokens(path, '\n', parser, debug, "Lines", io);
+}
+
+struct ParallelOptions {
+    size_t thread_count = 0;                // 0 = std::thread::hardware_concurrency()
+    size_t min_chunk_bytes = 1024 * 1024;   // small inputs are not worth a thread
+    IoOptions io = default_io_options();     // how regular files are loaded
+};
+
+namespace detail {
+    // Runs work(i) for every i < count as separate tasks on the shared work-stealing pool, so fast_io never starts
+    // threads of its own on top of the ones the caller may already run on.
+    template<typename Work>
+    void run_parallel(size_t count, Work&& work) {
+        threading::parallel_for(0, count, 1, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) work(i);
+        });
+    }
+
+    struct Chunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+    };
+
+    inline bool is_line_break(char c) {
+        return c == '\n' || c == '\r';
+    }
+
+    // Cut [data, data + size) into at most chunk_count pieces, each ending right after a line break.
+    // Cutting between the two bytes of a CRLF pair is harmless because empty lines are dropped anyway.
+    inline std::vector<Chunk> split_at_line_breaks(const char* data, size_t size, size_t chunk_count) {
+        std::vector<Chunk> chunks;
+        chunks.reserve(chunk_count);
+
+        const char* end = data + size;
+        const char* chunk_start = data;
+        for (size_t i = 1; i < chunk_count && chunk_start < end; ++i) {
+            const char* cut = data + size / chunk_count * i;
+            if (cut <= chunk_start) continue;
+            while (cut < end && !is_line_break(*cut)) ++cut;
+            if (cut < end) ++cut;
+            chunks.push_back({chunk_start, cut});
+            chunk_start = cut;
+        }
+        if (chunk_start < end) chunks.push_back({chunk_start, end});
+        return chunks;
+    }
+
+    inline size_t resolve_chunk_count(size_t size, const ParallelOptions& options) {
+        size_t threads = options.thread_count;
+        if (threads == 0) threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        const size_t by_size = std::max<size_t>(1, size / std::max<size_t>(1, options.min_chunk_bytes));
+        return std::min(threads, by_size);
+    }
+}
+
+// Parallel read_lines. The file is cut at line breaks into one chunk per thread and every chunk gets its own
+// parser from make_parser(chunk_index), so parsers need no synchronisation. Chunks run as tasks on the shared
+// work-stealing pool.
+// Once all chunks are done, merge(parser) is called on the calling thread for each parser in file order,
+// so merge can both reduce (sum counters) and concatenate (append vectors) while keeping line order.
+// Parser must implement: void operator()(const char* line_start, size_t line_length)
+template<typename ParserFactory, typename Merge>
+std::optional<ReadStats> read_lines_parallel(const char* path, ParserFactory&& make_parser, Merge&& merge,
+                                             ParallelOptions options = {}, bool debug = false) {
+    using Parser = std::decay_t<std::invoke_result_t<ParserFactory&, size_t>>;
+
     ReadStats stats;
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    detail::MappedFile file;
-    if (!file.open(path)) {
-        if (debug) std::cerr << "[fast_io] Failed to open: " << path << '\n';
-        return std::nullopt;
+    detail::LoadedFile file;
+    if (!detail::load_file(file, path, options.io)) {
+        // Streams cannot be split up front, so they get a single parser.
+        Parser parser = make_parser(size_t{0});
+        auto stream_stats = detail::read_tokens(path, '\n', parser, debug, "Lines", options.io);
+        if (stream_stats) merge(std::move(parser));
+        return stream_stats;
     }
 
     stats.file_size = file.size;
+    stats.backend = file.backend;
 
     if (file.size == 0) {
         if (debug) std::cout << "[fast_io] Empty file\n";
-        return stats;  // valid empty file
+        return stats;
     }
 
-    const char* ptr = file.data;
-    const char* end = file.data + file.size;
-    const char* line_start = ptr;
+    const auto chunks = detail::split_at_line_breaks(file.data, file.size,
+                                                     detail::resolve_chunk_count(file.size, options));
 
-    while (ptr < end) {
-        if (*ptr == '\n' || *ptr == '\r') {
-            size_t line_len = ptr - line_start;
-            if (line_len > 0) {
-                parser(line_start, line_len);
-                ++stats.line_count;
-            }
+    std::vector<Parser> parsers;
+    parsers.reserve(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        parsers.push_back(make_parser(i));
+    }
 
-            if (ptr + 1 < end && (ptr[1] == '\n' || ptr[1] == '\r') && ptr[0] != ptr[1]) {
-                ++ptr;
-            }
-            line_start = ptr + 1;
-        }
-        ++ptr;
+    std::vector<size_t> line_counts(chunks.size(), 0);
+    {
+        INSTRUMENT_SCOPE("split");
+        detail::run_parallel(chunks.size(), [&](size_t i) {
+            line_counts[i] = for_each_line(chunks[i].begin, chunks[i].end, parsers[i]);
+        });
     }
 
-    if (line_start < end) {
-        parser(line_start, end - line_start);
-        ++stats.line_count;
+    {
+        INSTRUMENT_SCOPE("merge");
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            merge(std::move(parsers[i]));
+            stats.line_count += line_counts[i];
+        }
     }
 
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -142,58 +370,350 @@ std::optional<ReadStats> read_lines(const char* path, LineParser&& parser, bool
 
     if (debug) {
         std::cout << "[fast_io] File: " << path << '\n'
-                  << "[fast_io] Size: " << stats.file_size << " bytes\n"
+                  << "[fast_io] Size: " << stats.file_size << " bytes (" << to_string(stats.backend) << ")\n"
                   << "[fast_io] Lines: " << stats.line_count << '\n'
+                  << "[fast_io] Chunks: " << chunks.size() << '\n'
                   << "[fast_io] Time: " << stats.parse_time_ms << " ms\n";
     }
 
     return stats;
 }
 
-template<typename TokenParser>
-std::optional<ReadStats> read_delimited(const char* path, char delimiter, TokenParser&& parser, bool debug = false) {
+// A run of non-empty lines; sections are separated by one or more blank lines.
+struct Section {
+    size_t index = 0;
+    const char* begin = nullptr;   // first byte of the first line
+    const char* end = nullptr;     // one past the last byte of the last line
+    size_t line_count = 0;         // non-empty lines, e.g. to size the section's containers up front
+
+    [[nodiscard]] size_t size() const { return static_cast<size_t>(end - begin); }
+};
+
+namespace detail {
+    // Line breaks between two non-empty lines, CRLF/LFCR pairs counted once (paired the same way the scalar
+    // splitters pair them). Two or more breaks mean there is a blank line in between.
+    struct SectionScanner {
+        std::vector<Section> sections;
+        const char* line_start = nullptr;
+        const char* last_break = nullptr;
+        size_t break_count = 0;
+        bool open = false;
+        bool can_pair = false;  // last_break may still be the first byte of a CRLF/LFCR pair
+
+        void on_line(const char* begin, const char* end) {
+            if (!open) {
+                sections.push_back({sections.size(), begin, end, 0});
+                open = true;
+            }
+            sections.back().end = end;
+            ++sections.back().line_count;
+            break_count = 0;
+        }
+
+        void on_break(const char* separator) {
+            if (separator > line_start) {
+                on_line(line_start, separator);
+            } else if (can_pair && separator == last_break + 1 && *separator != *last_break) {
+                can_pair = false;  // second byte of a pair
+                line_start = separator + 1;
+                return;
+            }
+            last_break = separator;
+            can_pair = true;
+            if (++break_count == 2) open = false;
+            line_start = separator + 1;
+        }
+    };
+
+    // Whole stream into memory: sections are found up front, so there is nothing to gain from streaming.
+    inline bool read_all(const char* path, std::string& buffer) {
+        InputStream input;
+        if (!input.open(path)) return false;
+
+        StreamReader reader(input);
+        StreamReader::Block block;
+        while (reader.next(block)) {
+            buffer.append(block.data, block.size);
+            reader.release();
+        }
+        return !reader.failed();
+    }
+
+    template<typename ParserFactory, typename Merge>
+    size_t parse_sections(const std::vector<Section>& sections, ParserFactory& make_parser, Merge& merge) {
+        using Parser = std::decay_t<std::invoke_result_t<ParserFactory&, const Section&>>;
+
+        std::vector<Parser> parsers;
+        parsers.reserve(sections.size());
+        for (const Section& section : sections) {
+            parsers.push_back(make_parser(section));
+        }
+
+        // Each section is parsed by a single thread; idle pool threads take the next one.
+        {
+            INSTRUMENT_SCOPE("split");
+            run_parallel(sections.size(), [&](size_t i) {
+                for_each_line(sections[i].begin, sections[i].end, parsers[i]);
+            });
+        }
+
+        INSTRUMENT_SCOPE("merge");
+        size_t line_count = 0;
+        for (size_t i = 0; i < sections.size(); ++i) {
+            merge(std::move(parsers[i]));
+            line_count += sections[i].line_count;
+        }
+        return line_count;
+    }
+}
+
+// Sections of an in-memory buffer, in order. Leading, trailing and repeated blank lines produce no empty sections.
+inline std::vector<Section> find_sections(const char* begin, const char* end) {
+    detail::SectionScanner scanner;
+    scanner.line_start = begin;
+    detail::scan_separators(begin, end, '\n', [&](const char* separator) { scanner.on_break(separator); });
+    if (scanner.line_start < end) scanner.on_line(scanner.line_start, end);
+    return std::move(scanner.sections);
+}
+
+// Section-aware read_lines. The blank lines between sections are located first, then every section gets its own
+// parser from make_parser(const Section&) - which knows the section's index, byte span and line count - and its
+// lines are fed to it. Sections are parsed concurrently on the shared work-stealing pool, one task per section;
+// merge(parser) is called on the calling thread for each section in file order.
+// Parser must implement: void operator()(const char* line_start, size_t line_length)
+template<typename ParserFactory, typename Merge>
+std::optional<ReadStats> read_sections(const char* path, ParserFactory&& make_parser, Merge&& merge,
+                                       ParallelOptions options = {}, bool debug = false) {
     ReadStats stats;
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    detail::MappedFile file;
-    if (!file.open(path)) {
-        if (debug) std::cerr << "[fast_io] Failed to open: " << path << '\n';
-        return std::nullopt;
+    detail::LoadedFile file;
+    std::string buffer;
+    const char* data = nullptr;
+    if (detail::load_file(file, path, options.io)) {
+        data = file.data;
+        stats.file_size = file.size;
+        stats.backend = file.backend;
+    } else {
+        if (!detail::read_all(path, buffer)) {
+            if (debug) std::cerr << "[fast_io] Failed to read: " << path << '\n';
+            return std::nullopt;
+        }
+        data = buffer.data();
+        stats.file_size = buffer.size();
     }
 
-    stats.file_size = file.size;
-
-    if (file.size == 0) {
+    if (stats.file_size == 0) {
         if (debug) std::cout << "[fast_io] Empty file\n";
         return stats;
     }
 
-    const char* ptr = file.data;
-    const char* end = file.data + file.size;
-    const char* token_start = ptr;
+    const auto sections = [&] {
+        INSTRUMENT_SCOPE("sections");
+        return find_sections(data, data + stats.file_size);
+    }();
+    stats.section_count = sections.size();
+    if (!sections.empty()) stats.line_count = detail::parse_sections(sections, make_parser, merge);
 
-    while (ptr < end) {
-        if (*ptr == delimiter || *ptr == '\n' || *ptr == '\r') {
-            size_t token_len = ptr - token_start;
-            if (token_len > 0) {
-                parser(token_start, token_len);
-                ++stats.line_count;  // reusing as token count
-            }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    stats.parse_time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
 
-            // Handle \r\n
-            if ((*ptr == '\r' || *ptr == '\n') && ptr + 1 < end &&
-                (ptr[1] == '\n' || ptr[1] == '\r') && ptr[0] != ptr[1]) {
-                ++ptr;
-            }
-            token_start = ptr + 1;
+    if (debug) {
+        std::cout << "[fast_io] File: " << path << '\n'
+                  << "[fast_io] Size: " << stats.file_size << " bytes (" << to_string(stats.backend) << ")\n"
+                  << "[fast_io] Lines: " << stats.line_count << '\n'
+                  << "[fast_io] Sections: " << stats.section_count << '\n'
+                  << "[fast_io] Time: " << stats.parse_time_ms << " ms\n";
+    }
+
+    return stats;
+}
+
+// Lines [first, last) of a LineIndex.
+struct LineRange {
+    size_t first = 0;
+    size_t last = 0;
+
+    [[nodiscard]] size_t size() const { return last - first; }
+};
+
+// Start offsets of the non-empty lines of an in-memory buffer, so callers can size their containers exactly, jump to
+// any line and split work by line count instead of by bytes. Blank lines get no line number; sections are the ones
+// find_sections reports. Only the starts are stored (one size_t per line), line ends are recovered on access.
+class LineIndex {
+public:
+    LineIndex() = default;
+    LineIndex(const char* data, size_t size, std::vector<size_t> starts, std::vector<size_t> section_starts)
+        : data_(data), size_(size), starts_(std::move(starts)), section_starts_(std::move(section_starts)) {}
+
+    [[nodiscard]] size_t size() const { return starts_.size(); }
+    [[nodiscard]] bool empty() const { return starts_.empty(); }
+    [[nodiscard]] size_t byte_size() const { return size_; }
+
+    [[nodiscard]] const char* line_begin(size_t i) const { return data_ + starts_[i]; }
+
+    // The line breaks in front of the next line (or at the end of the buffer) are stepped over.
+    [[nodiscard]] const char* line_end(size_t i) const {
+        const char* begin = line_begin(i);
+        const char* end = i + 1 < starts_.size() ? data_ + starts_[i + 1] : data_ + size_;
+        while (end > begin && (end[-1] == '\n' || end[-1] == '\r')) --end;
+        return end;
+    }
+
+    [[nodiscard]] std::string_view line(size_t i) const {
+        const char* begin = line_begin(i);
+        return {begin, static_cast<size_t>(line_end(i) - begin)};
+    }
+
+    [[nodiscard]] size_t section_count() const { return section_starts_.size(); }
+
+    [[nodiscard]] LineRange section_lines(size_t s) const {
+        return {section_starts_[s], s + 1 < section_starts_.size() ? section_starts_[s + 1] : starts_.size()};
+    }
+
+    [[nodiscard]] Section section(size_t s) const {
+        const LineRange lines = section_lines(s);
+        return {s, line_begin(lines.first), line_end(lines.last - 1), lines.size()};
+    }
+
+    // Threads worth using on this buffer: options.thread_count, but no more than one per min_chunk_bytes.
+    [[nodiscard]] size_t thread_count(const ParallelOptions& options = {}) const;
+
+    // parts consecutive ranges covering every line, their sizes differ by at most one. Fewer when there are fewer lines.
+    [[nodiscard]] std::vector<LineRange> split(size_t parts) const {
+        parts = std::max<size_t>(1, std::min(parts, starts_.size()));
+        std::vector<LineRange> ranges;
+        ranges.reserve(parts);
+        for (size_t p = 0; p < parts; ++p) {
+            ranges.push_back({starts_.size() * p / parts, starts_.size() * (p + 1) / parts});
+        }
+        return ranges;
+    }
+
+    // Line parser must implement: void operator()(const char* line_start, size_t line_length)
+    template<typename LineParser>
+    void for_each_line(LineRange lines, LineParser&& parser) const {
+        for (size_t i = lines.first; i < lines.last; ++i) {
+            const char* begin = line_begin(i);
+            parser(begin, static_cast<size_t>(line_end(i) - begin));
+        }
+    }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<size_t> starts_;
+    std::vector<size_t> section_starts_;  // line number of each section's first line
+};
+
+namespace detail {
+
+    // Whether a blank line separates the line starting at line from the previous non-empty line (or there is no
+    // previous line). Breaks are paired the way the scalar splitters pair them.
+    inline bool starts_section(const char* data, const char* line) {
+        const char* gap = line;
+        while (gap > data && is_line_break(gap[-1])) --gap;
+        if (gap == data) return true;
+        size_t breaks = 0;
+        for (const char* p = gap; p < line; ++p) {
+            if (p + 1 < line && p[0] != p[1]) ++p;
+            if (++breaks == 2) return true;
+        }
+        return false;
+    }
+
+    template<typename OnLine>
+    void scan_line_starts(const Chunk& chunk, OnLine&& on_line) {
+        const char* line_start = chunk.begin;
+        scan_separators(chunk.begin, chunk.end, '\n', [&](const char* separator) {
+            if (separator > line_start) on_line(line_start);
+            line_start = separator + 1;
+        });
+        if (line_start < chunk.end) on_line(line_start);
+    }
+}
+
+inline size_t LineIndex::thread_count(const ParallelOptions& options) const {
+    return detail::resolve_chunk_count(size_, options);
+}
+
+// Index of [begin, end), built with the SIMD separator scan. With thread_count > 1 the buffer is cut at line breaks
+// and every piece is scanned twice as a task on the shared pool: once to count its lines, so the offset table is allocated
+// exactly once, then to fill in its part of the table.
+inline LineIndex index_lines(const char* begin, const char* end, size_t thread_count = 1) {
+    const size_t size = static_cast<size_t>(end - begin);
+    const auto chunks = detail::split_at_line_breaks(begin, size, std::max<size_t>(1, thread_count));
+
+    std::vector<size_t> first_line(chunks.size() + 1, 0);
+    detail::run_parallel(chunks.size(), [&](size_t c) {
+        size_t lines = 0;
+        detail::scan_line_starts(chunks[c], [&](const char*) { ++lines; });
+        first_line[c + 1] = lines;
+    });
+    for (size_t c = 0; c < chunks.size(); ++c) first_line[c + 1] += first_line[c];
+
+    std::vector<size_t> starts(first_line.back());
+    std::vector<std::vector<size_t>> chunk_sections(chunks.size());
+    detail::run_parallel(chunks.size(), [&](size_t c) {
+        size_t line = first_line[c];
+        detail::scan_line_starts(chunks[c], [&](const char* line_start) {
+            if (detail::starts_section(begin, line_start)) chunk_sections[c].push_back(line);
+            starts[line++] = static_cast<size_t>(line_start - begin);
+        });
+    });
+
+    std::vector<size_t> section_starts;
+    for (const auto& sections : chunk_sections) {
+        section_starts.insert(section_starts.end(), sections.begin(), sections.end());
+    }
+    return {begin, size, std::move(starts), std::move(section_starts)};
+}
+
+// Runs work(part, range) for every range as a task on the shared work-stealing pool.
+template<typename Work>
+void parallel_for_lines(const std::vector<LineRange>& ranges, Work&& work) {
+    detail::run_parallel(ranges.size(), [&](size_t part) { work(part, ranges[part]); });
+}
+
+// Indexed read: the file is loaded, its line offsets are indexed (in parallel for large files), then
+// on_index(const LineIndex&) is called once with the whole index. The index points into the loaded file and is only
+// valid during the call. Streams are read into memory first.
+template<typename OnIndex>
+std::optional<ReadStats> read_indexed(const char* path, OnIndex&& on_index, ParallelOptions options = {},
+                                      bool debug = false) {
+    ReadStats stats;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    detail::LoadedFile file;
+    std::string buffer;
+    const char* data = nullptr;
+    if (detail::load_file(file, path, options.io)) {
+        data = file.data;
+        stats.file_size = file.size;
+        stats.backend = file.backend;
+    } else {
+        if (!detail::read_all(path, buffer)) {
+            if (debug) std::cerr << "[fast_io] Failed to read: " << path << '\n';
+            return std::nullopt;
         }
-        ++ptr;
+        data = buffer.data();
+        stats.file_size = buffer.size();
     }
 
-    // Final token without trailing delimiter/newline
-    if (token_start < end) {
-        parser(token_start, end - token_start);
-        ++stats.line_count;
+    if (stats.file_size == 0) {
+        if (debug) std::cout << "[fast_io] Empty file\n";
+        return stats;
+    }
+
+    const auto index = [&] {
+        INSTRUMENT_SCOPE("index");
+        return index_lines(data, data + stats.file_size, detail::resolve_chunk_count(stats.file_size, options));
+    }();
+    stats.line_count = index.size();
+    stats.section_count = index.section_count();
+    {
+        INSTRUMENT_SCOPE("split");
+        on_index(index);
     }
 
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -201,31 +721,26 @@ std::optional<ReadStats> read_delimited(const char* path, char delimiter, TokenP
 
     if (debug) {
         std::cout << "[fast_io] File: " << path << '\n'
-                  << "[fast_io] Size: " << stats.file_size << " bytes\n"
-                  << "[fast_io] Tokens: " << stats.line_count << '\n'
+                  << "[fast_io] Size: " << stats.file_size << " bytes (" << to_string(stats.backend) << ")\n"
+                  << "[fast_io] Lines: " << stats.line_count << '\n'
+                  << "[fast_io] Sections: " << stats.section_count << '\n'
                   << "[fast_io] Time: " << stats.parse_time_ms << " ms\n";
     }
 
     return stats;
 }
 
-// Convenience wrapper for CSV
 template<typename TokenParser>
-std::optional<ReadStats> read_csv(const char* path, TokenParser&& parser, bool debug = false) {
-    return read_delimited(path, ',', std::forward<TokenParser>(parser), debug);
+std::optional<ReadStats> read_delimited(const char* path, char delimiter, TokenParser&& parser, bool debug = false,
+                                        const IoOptions& io = default_io_options()) {
+    return detail::read_tokens(path, delimiter, parser, debug, "Tokens", io);
 }
 
-// Convenience: parse integers with optional prefix char
-template<typename IntType = int>
-inline IntType parse_int(const char* start, size_t len) {
-    IntType value = 0;
-    for (size_t i = 0; i < len; ++i) {
-        char c = start[i];
-        if (c >= '0' && c <= '9') {
-            value = value * 10 + (c - '0');
-        }
-    }
-    return value;
+// Convenience wrapper for CSV
+template<typename TokenParser>
+std::optional<ReadStats> read_csv(const char* path, TokenParser&& parser, bool debug = false,
+                                  const IoOptions& io = default_io_options()) {
+    return read_delimited(path, ',', std::forward<TokenParser>(parser), debug, io);
 }
 
 }  // namespace fast_io
@@ -0,0 +1,155 @@
+#ifndef UTILS_GRID_HPP
+#define UTILS_GRID_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+//2D grid container shared by the grid puzzles. General purpose. Not part of the solutions as such.
+namespace grid {
+
+    struct GridDef {
+        int width = 0;
+        int height = 0;
+    };
+
+    struct GridCoord {
+        int x = 0;
+        int y = 0;
+    };
+
+    using GridIndex = int;
+
+    // Neighborhood as a compile-time list of offsets, so loops over it unroll and inline.
+    template<GridCoord... Offsets>
+    struct Stencil {
+        static constexpr size_t size = sizeof...(Offsets);
+        static constexpr std::array<GridCoord, size> offsets{Offsets...};
+
+        static constexpr int reach() {
+            int r = 0;
+            for (const GridCoord& offset : offsets) {
+                r = std::max({r, std::abs(offset.x), std::abs(offset.y)});
+            }
+            return r;
+        }
+    };
+
+    using Neighbors4 = Stencil<GridCoord{0, -1}, GridCoord{-1, 0}, GridCoord{1, 0}, GridCoord{0, 1}>;
+
+    using Neighbors8 = Stencil<GridCoord{-1, -1}, GridCoord{0, -1}, GridCoord{1, -1},
+                               GridCoord{-1, 0},                     GridCoord{1, 0},
+                               GridCoord{-1, 1},  GridCoord{0, 1},  GridCoord{1, 1}>;
+
+    // Row-major grid with a one-cell sentinel ring around it. Border cells hold a caller-chosen value (e.g. "empty"),
+    // so stencils can read every neighbor of an interior cell without bounds checks.
+    // Indices (GridIndex) are into the padded storage; use index(x, y) to get one.
+    template<typename T>
+    class Grid {
+    public:
+        static constexpr int BORDER = 1;
+
+        Grid() = default;
+
+        explicit Grid(GridDef def, T fill = T{}, T border = T{})
+            : def_(def),
+              stride_(def.width + 2 * BORDER),
+              cells_(static_cast<size_t>(def.width + 2 * BORDER) * (def.height + 2 * BORDER), border) {
+            for (int y = 0; y < def_.height; y++) {
+                T* cells = row(y);
+                for (int x = 0; x < def_.width; x++) cells[x] = fill;
+            }
+        }
+
+        [[nodiscard]] const GridDef& def() const { return def_; }
+        [[nodiscard]] int width() const { return def_.width; }
+        [[nodiscard]] int height() const { return def_.height; }
+        [[nodiscard]] int stride() const { return stride_; }
+
+        // x and y may reach one cell into the border.
+        [[nodiscard]] GridIndex index(int x, int y) const {
+            return (y + BORDER) * stride_ + x + BORDER;
+        }
+
+        [[nodiscard]] GridCoord coord(GridIndex index) const {
+            return {index % stride_ - BORDER, index / stride_ - BORDER};
+        }
+
+        T& operator[](GridIndex index) { return cells_[index]; }
+        const T& operator[](GridIndex index) const { return cells_[index]; }
+
+        T& operator()(int x, int y) { return cells_[index(x, y)]; }
+        const T& operator()(int x, int y) const { return cells_[index(x, y)]; }
+
+        // Pointer to cell (0, y); row(y)[-1] and row(y)[width] are border cells.
+        T* row(int y) { return cells_.data() + index(0, y); }
+        const T* row(int y) const { return cells_.data() + index(0, y); }
+
+        std::vector<T>& storage() { return cells_; }
+        const std::vector<T>& storage() const { return cells_; }
+
+        // Stencil offsets resolved to index deltas for this grid's stride.
+        template<typename StencilT>
+        [[nodiscard]] std::array<GridIndex, StencilT::size> neighbor_offsets() const {
+            static_assert(StencilT::reach() <= BORDER, "stencil reaches past the sentinel border");
+            std::array<GridIndex, StencilT::size> deltas{};
+            for (size_t i = 0; i < StencilT::size; i++) {
+                deltas[i] = StencilT::offsets[i].x + StencilT::offsets[i].y * stride_;
+            }
+            return deltas;
+        }
+
+        // Visit the interior cells in row-major order.
+        template<typename Func>
+        void for_each_index(Func&& func) const {
+            for (int y = 0; y < def_.height; y++) {
+                const GridIndex first = index(0, y);
+                for (GridIndex i = first; i < first + def_.width; i++) func(i);
+            }
+        }
+
+        // func(neighbor_index) for every neighbor of an interior cell; no bounds checks.
+        template<typename StencilT, typename Func>
+        void for_each_neighbor(GridIndex index, Func&& func) const {
+            static_assert(StencilT::reach() <= BORDER, "stencil reaches past the sentinel border");
+            for (const GridCoord& offset : StencilT::offsets) {
+                func(index + offset.x + offset.y * stride_);
+            }
+        }
+
+        template<typename StencilT, typename Pred>
+        [[nodiscard]] int count_neighbors(GridIndex index, Pred&& pred) const {
+            int count = 0;
+            for_each_neighbor<StencilT>(index, [&](GridIndex neighbor) {
+                count += pred(cells_[neighbor]) ? 1 : 0;
+            });
+            return count;
+        }
+
+        // out(x, y) += transform(this(x + dx, y + dy)) for every stencil offset. Works a whole row per offset over
+        // contiguous memory, so the inner loop auto-vectorizes. out must have the same size.
+        template<typename StencilT, typename U, typename Transform>
+        void accumulate_neighbors(Grid<U>& out, Transform&& transform) const {
+            static_assert(StencilT::reach() <= BORDER, "stencil reaches past the sentinel border");
+            for (int y = 0; y < def_.height; y++) {
+                U* target = out.row(y);
+                for (const GridCoord& offset : StencilT::offsets) {
+                    const T* source = row(y + offset.y) + offset.x;
+                    for (int x = 0; x < def_.width; x++) {
+                        target[x] += transform(source[x]);
+                    }
+                }
+            }
+        }
+
+    private:
+        GridDef def_;
+        int stride_ = 0;
+        std::vector<T> cells_;
+    };
+}
+
+#endif
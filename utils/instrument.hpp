@@ -0,0 +1,396 @@
+#ifndef UTILS_INSTRUMENT_HPP
+#define UTILS_INSTRUMENT_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "memory-tracker.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+    #define INSTRUMENT_HAS_TSC 1
+#endif
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/types.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #define INSTRUMENT_HAS_PERF 1
+#endif
+
+//phase timers and hardware counters for the parse/solve hot paths.
+//INSTRUMENT_SCOPE("name") times the enclosing block; nested scopes report as "outer/inner". Without AOC_INSTRUMENT
+//(CMake option of the same name) the macro expands to nothing. Builds with AOC_TRACK_ALLOCATIONS also report heap
+//allocations and RSS per phase (see memory-tracker.hpp).
+namespace instrument {
+
+enum Counter : size_t { Cycles = 0, Instructions, CacheMisses, BranchMisses, COUNTER_COUNT };
+
+inline const char* to_string(Counter counter) {
+    switch (counter) {
+        case Cycles:        return "cycles";
+        case Instructions:  return "instructions";
+        case CacheMisses:   return "cache_misses";
+        case BranchMisses:  return "branch_misses";
+        case COUNTER_COUNT: break;
+    }
+    return "unknown";
+}
+
+using CounterValues = std::array<uint64_t, COUNTER_COUNT>;
+
+struct Phase {
+    std::string path;       // scope names from the outermost one, joined with '/'
+    size_t depth = 0;
+    uint64_t calls = 0;
+    uint64_t ns = 0;        // steady_clock
+    uint64_t ticks = 0;     // time stamp counter, 0 where there is none
+    CounterValues counters{};
+    uint64_t allocations = 0;     // the memory fields stay 0 without AOC_TRACK_ALLOCATIONS
+    uint64_t allocated_bytes = 0;
+    uint64_t reallocations = 0;
+    uint64_t heap_peak_bytes = 0; // highest live heap size inside the phase
+    uint64_t rss_kb = 0;          // resident set size at the end of the last call
+};
+
+// Heap usage of one phase call, taken by Scope.
+struct MemoryDelta {
+    memory::Snapshot allocated;  // differences, live_bytes unused
+    uint64_t heap_peak_bytes = 0;
+    uint64_t rss_kb = 0;
+};
+
+inline uint64_t read_ticks() {
+#if defined(INSTRUMENT_HAS_TSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Process wide phase totals. Phases keep the order in which they were first entered.
+// Hardware counters are kept per thread: the thread calling enable_counters and every thread that attached
+// itself (the threading pools do so for their workers) gets its own group of perf events. read_counters sums all
+// groups, so a phase counts the work of every attached thread while it ran, including loop bodies that ran on
+// pool workers, and also whatever unrelated work those threads did in the same time span.
+class Profiler {
+public:
+    // Never destroyed: pool workers detach while the pools are torn down at exit.
+    static Profiler& instance() {
+        static Profiler* profiler = new Profiler();
+        return *profiler;
+    }
+
+    // Opens the perf events (user space only) for the calling thread and all attached ones. Returns false where
+    // perf_event_open is missing or not permitted (see /proc/sys/kernel/perf_event_paranoid).
+    bool enable_counters() {
+#if defined(INSTRUMENT_HAS_PERF)
+        std::lock_guard lock(mutex_);
+        if (counters_enabled_) return true;
+
+        const pid_t self = current_thread_id();
+        if (std::none_of(threads_.begin(), threads_.end(), [&](const ThreadCounters& t) { return t.tid == self; })) {
+            threads_.push_back({self});
+        }
+        for (ThreadCounters& thread : threads_) {
+            if (!open_counters(thread)) {
+                close_counters();
+                return false;
+            }
+        }
+        counters_enabled_ = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    [[nodiscard]] bool counters_enabled() const { return counters_enabled_; }
+
+    // Sum over the attached threads, plus what threads that detached since had counted.
+    [[nodiscard]] CounterValues read_counters() const {
+        CounterValues values{};
+#if defined(INSTRUMENT_HAS_PERF)
+        std::lock_guard lock(mutex_);
+        if (!counters_enabled_) return values;
+        values = retired_;
+        for (const ThreadCounters& thread : threads_) {
+            const CounterValues counted = read_counters(thread);
+            for (size_t c = 0; c < COUNTER_COUNT; ++c) values[c] += counted[c];
+        }
+#endif
+        return values;
+    }
+
+    // Adds the calling thread to the counted ones, opening its events right away when counters are on.
+    void attach_thread() {
+#if defined(INSTRUMENT_HAS_PERF)
+        std::lock_guard lock(mutex_);
+        threads_.push_back({current_thread_id()});
+        if (counters_enabled_ && !open_counters(threads_.back())) close_counters(threads_.back());
+#endif
+    }
+
+    // Call on the attached thread before it exits; its counts so far stay in the totals.
+    void detach_thread() {
+#if defined(INSTRUMENT_HAS_PERF)
+        std::lock_guard lock(mutex_);
+        const pid_t self = current_thread_id();
+        const auto thread =
+            std::find_if(threads_.begin(), threads_.end(), [&](const ThreadCounters& t) { return t.tid == self; });
+        if (thread == threads_.end()) return;
+        const CounterValues counted = read_counters(*thread);
+        for (size_t c = 0; c < COUNTER_COUNT; ++c) retired_[c] += counted[c];
+        close_counters(*thread);
+        threads_.erase(thread);
+#endif
+    }
+
+    void record(const std::string& path, size_t depth, uint64_t ns, uint64_t ticks, const CounterValues& counters,
+                const MemoryDelta& heap) {
+        std::lock_guard lock(mutex_);
+        Phase* phase = nullptr;
+        for (Phase& existing : phases_) {
+            if (existing.path == path) {
+                phase = &existing;
+                break;
+            }
+        }
+        if (phase == nullptr) {
+            phases_.push_back({path, depth});
+            phase = &phases_.back();
+        }
+        ++phase->calls;
+        phase->ns += ns;
+        phase->ticks += ticks;
+        for (size_t c = 0; c < COUNTER_COUNT; ++c) phase->counters[c] += counters[c];
+        phase->allocations += heap.allocated.allocations;
+        phase->allocated_bytes += heap.allocated.bytes;
+        phase->reallocations += heap.allocated.reallocations;
+        phase->heap_peak_bytes = std::max(phase->heap_peak_bytes, heap.heap_peak_bytes);
+        phase->rss_kb = heap.rss_kb;
+    }
+
+    [[nodiscard]] std::vector<Phase> phases() const {
+        std::lock_guard lock(mutex_);
+        return phases_;
+    }
+
+    void write_json(std::ostream& out, std::string_view binary, std::string_view input) const {
+        const auto phases = this->phases();
+        out << "{\n  \"binary\": ";
+        write_string(out, binary);
+        out << ",\n  \"input\": ";
+        write_string(out, input);
+#if defined(AOC_INSTRUMENT)
+        out << ",\n  \"instrumented\": true";
+#else
+        out << ",\n  \"instrumented\": false";
+#endif
+        out << ",\n  \"counters\": " << (counters_enabled_ ? "true" : "false");
+        out << ",\n  \"allocations\": " << (memory::tracking() ? "true" : "false");
+        out << ",\n  \"peak_rss_kb\": " << memory::peak_rss_kb();
+        out << ",\n  \"phases\": [";
+        for (size_t p = 0; p < phases.size(); ++p) {
+            const Phase& phase = phases[p];
+            out << (p == 0 ? "\n" : ",\n") << "    {\"path\": ";
+            write_string(out, phase.path);
+            out << ", \"depth\": " << phase.depth << ", \"calls\": " << phase.calls
+                << ", \"ns\": " << phase.ns << ", \"ticks\": " << phase.ticks;
+            if (counters_enabled_) {
+                for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+                    out << ", \"" << to_string(static_cast<Counter>(c)) << "\": " << phase.counters[c];
+                }
+            }
+            if (memory::tracking()) {
+                out << ", \"allocs\": " << phase.allocations << ", \"alloc_bytes\": " << phase.allocated_bytes
+                    << ", \"reallocs\": " << phase.reallocations << ", \"heap_peak_bytes\": " << phase.heap_peak_bytes
+                    << ", \"rss_kb\": " << phase.rss_kb;
+            }
+            out << '}';
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+#if defined(INSTRUMENT_HAS_PERF)
+    struct ThreadCounters {
+        pid_t tid = 0;
+        std::array<int, COUNTER_COUNT> fds{-1, -1, -1, -1};
+    };
+
+    static pid_t current_thread_id() { return static_cast<pid_t>(syscall(SYS_gettid)); }
+
+    // Events for one thread only (no inherit), so they can be read while the thread keeps running.
+    static bool open_counters(ThreadCounters& thread) {
+        constexpr uint64_t CONFIGS[COUNTER_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = CONFIGS[c];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            thread.fds[c] = static_cast<int>(syscall(__NR_perf_event_open, &attr, thread.tid, -1, -1, 0));
+            if (thread.fds[c] < 0) return false;
+        }
+        return true;
+    }
+
+    static CounterValues read_counters(const ThreadCounters& thread) {
+        CounterValues values{};
+        for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+            uint64_t value = 0;
+            if (thread.fds[c] >= 0 && ::read(thread.fds[c], &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value))) {
+                values[c] = value;
+            }
+        }
+        return values;
+    }
+
+    static void close_counters(ThreadCounters& thread) {
+        for (int& fd : thread.fds) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+    }
+#endif
+
+    Profiler() = default;
+
+    static void write_string(std::ostream& out, std::string_view text) {
+        out << '"';
+        for (const char c : text) {
+            if (c == '"' || c == '\\') out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+            else out << c;
+        }
+        out << '"';
+    }
+
+    void close_counters() {
+#if defined(INSTRUMENT_HAS_PERF)
+        for (ThreadCounters& thread : threads_) close_counters(thread);
+#endif
+        counters_enabled_ = false;
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<Phase> phases_;
+#if defined(INSTRUMENT_HAS_PERF)
+    std::vector<ThreadCounters> threads_;
+    CounterValues retired_{};
+#endif
+    bool counters_enabled_ = false;
+};
+
+// Keeps the constructing thread attached to the Profiler's counters for its lifetime. Long lived worker threads
+// hold one so their work shows up in the phases of the threads waiting on them.
+class CountedThread {
+public:
+    CountedThread() { Profiler::instance().attach_thread(); }
+    ~CountedThread() { Profiler::instance().detach_thread(); }
+
+    CountedThread(const CountedThread&) = delete;
+    CountedThread& operator=(const CountedThread&) = delete;
+};
+
+// Times the enclosing block. Scopes opened on another thread start a path of their own.
+class Scope {
+public:
+    explicit Scope(const char* name) {
+        auto& open = open_scopes();
+        open.push_back(name);
+        if constexpr (memory::tracking()) {
+            saved_peak_ = memory::begin_peak();
+            allocated_ = memory::snapshot();
+        }
+        counters_ = Profiler::instance().read_counters();
+        ticks_ = read_ticks();
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    ~Scope() {
+        const auto end = std::chrono::steady_clock::now();
+        const uint64_t ticks = read_ticks() - ticks_;
+        Profiler& profiler = Profiler::instance();
+        CounterValues counters = profiler.read_counters();
+        for (size_t c = 0; c < COUNTER_COUNT; ++c) counters[c] -= counters_[c];
+        MemoryDelta heap;
+        if constexpr (memory::tracking()) {
+            const memory::Snapshot now = memory::snapshot();
+            heap.allocated = {now.allocations - allocated_.allocations, now.bytes - allocated_.bytes,
+                                now.reallocations - allocated_.reallocations, 0};
+            heap.heap_peak_bytes = memory::end_peak(saved_peak_);
+            heap.rss_kb = memory::current_rss_kb();
+        }
+
+        auto& open = open_scopes();
+        std::string path;
+        for (const char* name : open) {
+            if (!path.empty()) path += '/';
+            path += name;
+        }
+        profiler.record(path, open.size() - 1,
+                        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count()),
+                        ticks, counters, heap);
+        open.pop_back();
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    static std::vector<const char*>& open_scopes() {
+        thread_local std::vector<const char*> open;
+        return open;
+    }
+
+    std::chrono::steady_clock::time_point start_;
+    uint64_t ticks_ = 0;
+    CounterValues counters_{};
+    memory::Snapshot allocated_;
+    uint64_t saved_peak_ = 0;
+};
+
+// Writes the report to path ("-" = stdout). The day mains call this for --profile.
+inline bool write_report(const char* path, std::string_view binary, std::string_view input) {
+    if (std::string_view(path) == "-") {
+        Profiler::instance().write_json(std::cout, binary, input);
+        return true;
+    }
+    std::ofstream out(path);
+    if (!out) return false;
+    Profiler::instance().write_json(out, binary, input);
+    return static_cast<bool>(out);
+}
+
+}  // namespace instrument
+
+#define INSTRUMENT_CONCAT_INNER(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_INNER(a, b)
+
+#if defined(AOC_INSTRUMENT)
+    #define INSTRUMENT_SCOPE(name) const ::instrument::Scope INSTRUMENT_CONCAT(instrument_scope_, __LINE__)(name)
+#else
+    #define INSTRUMENT_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef UTILS_INTERVAL_SET_HPP
+#define UTILS_INTERVAL_SET_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+//Set of disjoint closed integer intervals, for range puzzles that keep merging new ranges in. Not part of the solutions as such.
+namespace intervals {
+
+    template<typename T>
+    struct Interval {
+        T first = 0;
+        T last = 0;
+
+        [[nodiscard]] bool contains(T value) const {
+            return first <= value && value <= last;
+        }
+
+        bool operator<(const Interval& other) const {
+            return first < other.first;
+        }
+
+        [[nodiscard]] uint64_t size() const {
+            return static_cast<uint64_t>(last - first) + 1; //inclusive count
+        }
+    };
+
+    // Intervals keyed by first value in a balanced tree. Overlapping and adjacent intervals are coalesced on insert,
+    // so the stored ones are always disjoint with gaps between them, and the covered size is kept as a running total.
+    template<typename T>
+    class IntervalSet {
+        static_assert(std::is_integral_v<T>, "IntervalSet needs an integral value type");
+
+    public:
+        using const_iterator = typename std::map<T, T>::const_iterator;  // first -> last
+
+        // O(log n) amortized: every interval swallowed here was inserted once before.
+        void insert(T first, T last) {
+            auto it = intervals_.upper_bound(first);
+            if (it != intervals_.begin()) {
+                const auto previous = std::prev(it);
+                if (touches(previous->second, first)) {
+                    if (previous->second >= last) return;  // already covered
+                    first = previous->first;
+                    total_size_ -= span(previous->first, previous->second);
+                    intervals_.erase(previous);
+                }
+            }
+            while (it != intervals_.end() && touches(last, it->first)) {
+                last = std::max(last, it->second);
+                total_size_ -= span(it->first, it->second);
+                it = intervals_.erase(it);
+            }
+            intervals_.emplace_hint(it, first, last);
+            total_size_ += span(first, last);
+        }
+
+        void insert(const Interval<T>& interval) {
+            insert(interval.first, interval.last);
+        }
+
+        // Replaces the contents with a run sorted by first value (anything with .first and .last). One linear pass,
+        // every node is appended at the end of the tree.
+        template<typename Iterator>
+        void assign_sorted(Iterator begin, Iterator end) {
+            clear();
+            if (begin == end) return;
+
+            T first = begin->first;
+            T last = begin->last;
+            for (++begin; begin != end; ++begin) {
+                if (touches(last, begin->first)) {
+                    last = std::max(last, static_cast<T>(begin->last));
+                    continue;
+                }
+                append(first, last);
+                first = begin->first;
+                last = begin->last;
+            }
+            append(first, last);
+        }
+
+        [[nodiscard]] bool contains(T value) const {
+            auto it = intervals_.upper_bound(value);
+            if (it == intervals_.begin()) return false;
+            return value <= std::prev(it)->second;
+        }
+
+        // Batches at least as large as the set are sorted and swept against it in order; smaller ones are looked up
+        // one by one.
+        [[nodiscard]] size_t count_contained(const std::vector<T>& values) const {
+            size_t count = 0;
+            if (values.size() < intervals_.size()) {
+                for (const T value : values) count += contains(value);
+                return count;
+            }
+
+            std::vector<T> sorted = values;
+            std::sort(sorted.begin(), sorted.end());
+            auto it = intervals_.begin();
+            for (const T value : sorted) {
+                while (it != intervals_.end() && it->second < value) ++it;
+                if (it == intervals_.end()) break;
+                count += it->first <= value;
+            }
+            return count;
+        }
+
+        [[nodiscard]] size_t size() const { return intervals_.size(); }
+        [[nodiscard]] bool empty() const { return intervals_.empty(); }
+        [[nodiscard]] uint64_t total_size() const { return total_size_; }  // values covered
+
+        void clear() {
+            intervals_.clear();
+            total_size_ = 0;
+        }
+
+        [[nodiscard]] const_iterator begin() const { return intervals_.begin(); }
+        [[nodiscard]] const_iterator end() const { return intervals_.end(); }
+
+        [[nodiscard]] std::vector<Interval<T>> to_vector() const {
+            std::vector<Interval<T>> result;
+            result.reserve(intervals_.size());
+            for (const auto& [first, last] : intervals_) result.push_back({first, last});
+            return result;
+        }
+
+    private:
+        // a_last reaches b_first, or ends right before it.
+        static bool touches(T a_last, T b_first) {
+            return a_last >= b_first || (a_last < std::numeric_limits<T>::max() && a_last + 1 == b_first);
+        }
+
+        static uint64_t span(T first, T last) {
+            return static_cast<uint64_t>(last - first) + 1;
+        }
+
+        void append(T first, T last) {
+            intervals_.emplace_hint(intervals_.end(), first, last);
+            total_size_ += span(first, last);
+        }
+
+        std::map<T, T> intervals_;
+        uint64_t total_size_ = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,442 @@
+#ifndef UTILS_IO_BACKEND_HPP
+#define UTILS_IO_BACKEND_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+    #if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+        #define FAST_IO_HAS_IO_URING 1
+    #endif
+#endif
+
+//how fast_io gets a regular file into memory. The parsers only ever see a (data, size) buffer.
+namespace fast_io {
+
+enum class IoBackend : uint8_t {
+    Mmap = 0,   // map the file, pages fault in as the parser reaches them
+    Pread,      // pread() in blocks into a page aligned buffer
+    Direct,     // like Pread, but O_DIRECT: no page cache; falls back to Pread where unsupported
+    IoUring,    // queued reads through io_uring (raw syscalls); falls back to Pread where unavailable
+};
+
+inline const char* to_string(IoBackend backend) {
+    switch (backend) {
+        case IoBackend::Mmap:    return "mmap";
+        case IoBackend::Pread:   return "pread";
+        case IoBackend::Direct:  return "direct";
+        case IoBackend::IoUring: return "io_uring";
+    }
+    return "unknown";
+}
+
+struct IoOptions {
+    IoBackend backend = IoBackend::Mmap;
+    bool populate = false;                 // Mmap: MAP_POPULATE, fault the whole file in while mapping
+    bool huge_pages = false;               // MADV_HUGEPAGE on the mapping or read buffer (best effort)
+    size_t block_size = 1024 * 1024;       // read backends: bytes per request
+    unsigned queue_depth = 16;             // IoUring: requests in flight
+};
+
+// "mmap", "mmap-populate", "mmap-huge", "pread", "direct" or "io_uring" (as printed by bench_io).
+inline bool parse_io_options(const char* name, IoOptions& options) {
+    const std::string_view text(name);
+    IoOptions parsed;
+    if (text == "mmap") {
+        parsed.backend = IoBackend::Mmap;
+    } else if (text == "mmap-populate") {
+        parsed.backend = IoBackend::Mmap;
+        parsed.populate = true;
+    } else if (text == "mmap-huge") {
+        parsed.backend = IoBackend::Mmap;
+        parsed.populate = true;
+        parsed.huge_pages = true;
+    } else if (text == "pread") {
+        parsed.backend = IoBackend::Pread;
+    } else if (text == "direct") {
+        parsed.backend = IoBackend::Direct;
+    } else if (text == "io_uring") {
+        parsed.backend = IoBackend::IoUring;
+    } else {
+        return false;
+    }
+    options = parsed;
+    return true;
+}
+
+// Used by the read functions when no IoOptions are given. Starts from the FAST_IO_BACKEND environment variable
+// (see parse_io_options), so the backend can be picked per machine without rebuilding; set it before reading starts.
+inline IoOptions& default_io_options() {
+    static IoOptions options = [] {
+        IoOptions from_environment;
+        if (const char* name = std::getenv("FAST_IO_BACKEND")) parse_io_options(name, from_environment);
+        return from_environment;
+    }();
+    return options;
+}
+
+namespace detail {
+
+    constexpr size_t IO_ALIGNMENT = 4096;  // O_DIRECT wants buffer, offset and length aligned to the block size
+
+    inline size_t align_up(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+#if !defined(_WIN32)
+    // pread() until size bytes are in or the file ends; returns the bytes read, or -1 on error.
+    inline ssize_t read_blocks(int fd, char* buffer, size_t size, size_t offset, size_t block_size) {
+        size_t done = offset;
+        while (done < size) {
+            const ssize_t got = ::pread(fd, buffer + done, std::min(block_size, size - done), static_cast<off_t>(done));
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            if (got == 0) break;
+            done += static_cast<size_t>(got);
+        }
+        return static_cast<ssize_t>(done);
+    }
+
+    // O_DIRECT reads of whole aligned blocks; the last one comes back short at end of file. A short read anywhere
+    // else would leave the offset unaligned, so the rest then goes through the buffered fd.
+    inline ssize_t read_direct(int direct_fd, int fd, char* buffer, size_t size, size_t block_size) {
+        const size_t block = std::max(IO_ALIGNMENT, align_up(block_size, IO_ALIGNMENT));
+        size_t done = 0;
+        while (done < size) {
+            const size_t request = align_up(std::min(block, size - done), IO_ALIGNMENT);
+            const ssize_t got = ::pread(direct_fd, buffer + done, request, static_cast<off_t>(done));
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            if (got == 0) break;
+            done += static_cast<size_t>(got);
+            if (done % IO_ALIGNMENT != 0 && done < size) return read_blocks(fd, buffer, size, done, block_size);
+        }
+        return static_cast<ssize_t>(std::min(done, size));
+    }
+#endif
+
+#if defined(FAST_IO_HAS_IO_URING)
+    // Just enough of io_uring for sequential file reads, without liburing.
+    class IoUring {
+    public:
+        IoUring() = default;
+        IoUring(const IoUring&) = delete;
+        IoUring& operator=(const IoUring&) = delete;
+
+        ~IoUring() {
+            if (sqes_) munmap(sqes_, sqes_size_);
+            if (cq_ring_ && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+            if (sq_ring_) munmap(sq_ring_, sq_ring_size_);
+            if (ring_fd_ >= 0) ::close(ring_fd_);
+        }
+
+        // False if io_uring is missing or blocked (old kernel, seccomp, io_uring_disabled).
+        bool setup(unsigned entries) {
+            io_uring_params params{};
+            ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (ring_fd_ < 0) return false;
+
+            sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single_mmap) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+            sq_ring_ = map(sq_ring_size_, IORING_OFF_SQ_RING);
+            if (!sq_ring_) return false;
+            cq_ring_ = single_mmap ? sq_ring_ : map(cq_ring_size_, IORING_OFF_CQ_RING);
+            if (!cq_ring_) return false;
+            sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+            sqes_ = static_cast<io_uring_sqe*>(map(sqes_size_, IORING_OFF_SQES));
+            if (!sqes_) return false;
+
+            char* sq = static_cast<char*>(sq_ring_);
+            char* cq = static_cast<char*>(cq_ring_);
+            sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            entries_ = params.sq_entries;
+            return true;
+        }
+
+        [[nodiscard]] unsigned entries() const { return entries_; }
+
+        // Reads [0, size) of fd with up to entries() requests in flight; returns the bytes read, or -1.
+        ssize_t read_file(int fd, char* buffer, size_t size, size_t block_size) {
+            std::vector<Request> requests(entries_);
+            std::vector<unsigned> ready;  // request slots to (re)submit
+            std::vector<unsigned> free_slots;
+            for (unsigned slot = entries_; slot > 0; --slot) free_slots.push_back(slot - 1);
+
+            size_t next_offset = 0;
+            size_t done = 0;
+            unsigned in_flight = 0;
+            bool end_of_file = false;
+
+            while (true) {
+                while (!free_slots.empty() && next_offset < size && !end_of_file) {
+                    const unsigned slot = free_slots.back();
+                    free_slots.pop_back();
+                    requests[slot] = {next_offset, std::min(block_size, size - next_offset)};
+                    next_offset += requests[slot].length;
+                    ready.push_back(slot);
+                }
+                if (ready.empty() && in_flight == 0) break;
+
+                const unsigned submitted = static_cast<unsigned>(ready.size());
+                for (const unsigned slot : ready) push_read(fd, buffer, requests[slot], slot);
+                ready.clear();
+                in_flight += submitted;
+
+                while (true) {
+                    const long entered = syscall(__NR_io_uring_enter, ring_fd_, submitted, 1, IORING_ENTER_GETEVENTS,
+                                                 nullptr, 0);
+                    if (entered >= 0) break;
+                    if (errno != EINTR) return -1;
+                }
+
+                unsigned head = *cq_head_;
+                const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+                for (; head != tail; ++head) {
+                    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                    const auto slot = static_cast<unsigned>(cqe.user_data);
+                    --in_flight;
+                    if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                        ready.push_back(slot);
+                        continue;
+                    }
+                    if (cqe.res < 0) return -1;
+
+                    Request& request = requests[slot];
+                    const auto got = static_cast<size_t>(cqe.res);
+                    done += got;
+                    if (got == 0) {
+                        end_of_file = true;  // the file shrank since fstat
+                        free_slots.push_back(slot);
+                    } else if (got < request.length) {
+                        request.offset += got;  // short read: ask for the rest
+                        request.length -= got;
+                        ready.push_back(slot);
+                    } else {
+                        free_slots.push_back(slot);
+                    }
+                }
+                __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+            }
+            return static_cast<ssize_t>(std::min(done, size));
+        }
+
+    private:
+        struct Request {
+            size_t offset = 0;
+            size_t length = 0;
+        };
+
+        void* map(size_t size, off_t offset) const {
+            void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+            return address == MAP_FAILED ? nullptr : address;
+        }
+
+        void push_read(int fd, char* buffer, const Request& request, unsigned slot) {
+            const unsigned tail = *sq_tail_;
+            const unsigned index = tail & sq_mask_;
+            io_uring_sqe& sqe = sqes_[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_READ;
+            sqe.fd = fd;
+            sqe.off = request.offset;
+            sqe.addr = reinterpret_cast<uint64_t>(buffer + request.offset);
+            sqe.len = static_cast<uint32_t>(request.length);
+            sqe.user_data = slot;
+            sq_array_[index] = index;
+            __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        }
+
+        int ring_fd_ = -1;
+        void* sq_ring_ = nullptr;
+        void* cq_ring_ = nullptr;
+        io_uring_sqe* sqes_ = nullptr;
+        size_t sq_ring_size_ = 0;
+        size_t cq_ring_size_ = 0;
+        size_t sqes_size_ = 0;
+        unsigned* sq_tail_ = nullptr;
+        unsigned sq_mask_ = 0;
+        unsigned* sq_array_ = nullptr;
+        unsigned* cq_head_ = nullptr;
+        unsigned* cq_tail_ = nullptr;
+        unsigned cq_mask_ = 0;
+        io_uring_cqe* cqes_ = nullptr;
+        unsigned entries_ = 0;
+    };
+#endif
+
+    // A regular file in memory, loaded with the requested backend. backend reports the one actually used.
+    struct LoadedFile {
+        const char* data = nullptr;
+        size_t size = 0;
+        IoBackend backend = IoBackend::Mmap;
+
+#ifdef _WIN32
+        HANDLE file_handle = INVALID_HANDLE_VALUE;
+        HANDLE mapping_handle = nullptr;
+#else
+        int fd = -1;
+        char* buffer = nullptr;     // read backends: anonymous mapping, page aligned
+        size_t buffer_size = 0;
+#endif
+
+        // Windows only maps; the requested backend is ignored there.
+        bool open(const char* path, const IoOptions& options = default_io_options()) {
+#ifdef _WIN32
+            (void)options;
+            backend = IoBackend::Mmap;
+            file_handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ,
+                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_handle == INVALID_HANDLE_VALUE) return false;
+
+            LARGE_INTEGER file_size;
+            if (!GetFileSizeEx(file_handle, &file_size)) { close(); return false; }
+            size = static_cast<size_t>(file_size.QuadPart);
+
+            if (size == 0) return true;  // empty file is valid
+
+            mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping_handle) { close(); return false; }
+
+            data = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+            if (!data) { close(); return false; }
+            return true;
+#else
+            backend = options.backend;
+            fd = ::open(path, O_RDONLY);
+            if (fd < 0) return false;
+
+            struct stat st;
+            if (fstat(fd, &st) < 0) { close(); return false; }
+            size = static_cast<size_t>(st.st_size);
+
+            if (size == 0) return true;
+
+            const bool loaded = backend == IoBackend::Mmap ? map_file(options) : read_file(path, options);
+            if (!loaded) { close(); return false; }
+            return true;
+#endif
+        }
+
+        void close() {
+#ifdef _WIN32
+            if (data) { UnmapViewOfFile(data); data = nullptr; }
+            if (mapping_handle) { CloseHandle(mapping_handle); mapping_handle = nullptr; }
+            if (file_handle != INVALID_HANDLE_VALUE) { CloseHandle(file_handle); file_handle = INVALID_HANDLE_VALUE; }
+#else
+            if (buffer) {
+                munmap(buffer, buffer_size);
+                buffer = nullptr;
+            } else if (data && size > 0) {
+                munmap(const_cast<char*>(data), size);
+            }
+            data = nullptr;
+            if (fd >= 0) { ::close(fd); fd = -1; }
+#endif
+        }
+
+        ~LoadedFile() { close(); }
+
+        LoadedFile() = default;
+        LoadedFile(const LoadedFile&) = delete;
+        LoadedFile& operator=(const LoadedFile&) = delete;
+
+#ifndef _WIN32
+    private:
+        bool map_file(const IoOptions& options) {
+            int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+            if (options.populate) flags |= MAP_POPULATE;
+#endif
+            data = static_cast<const char*>(mmap(nullptr, size, PROT_READ, flags, fd, 0));
+            if (data == MAP_FAILED) { data = nullptr; return false; }
+
+            // Hint to OS we'll read sequentially
+            madvise(const_cast<char*>(data), size, MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+            // Only file systems with large folio support honour this for file mappings.
+            if (options.huge_pages) madvise(const_cast<char*>(data), size, MADV_HUGEPAGE);
+#endif
+            return true;
+        }
+
+        bool read_file(const char* path, const IoOptions& options) {
+            buffer_size = align_up(size, IO_ALIGNMENT);
+            void* mapping = mmap(nullptr, buffer_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED) { buffer_size = 0; return false; }
+            buffer = static_cast<char*>(mapping);
+#if defined(MADV_HUGEPAGE)
+            if (options.huge_pages) madvise(buffer, buffer_size, MADV_HUGEPAGE);
+#endif
+            const size_t block_size = std::max<size_t>(1, options.block_size);
+            ssize_t got = -1;
+
+            if (backend == IoBackend::Direct) {
+#if defined(O_DIRECT)
+                const int direct_fd = ::open(path, O_RDONLY | O_DIRECT);
+                if (direct_fd >= 0) {
+                    got = read_direct(direct_fd, fd, buffer, size, block_size);
+                    ::close(direct_fd);
+                }
+#endif
+                if (got < 0) backend = IoBackend::Pread;  // e.g. tmpfs rejects O_DIRECT
+            }
+
+            if (backend == IoBackend::IoUring) {
+#if defined(FAST_IO_HAS_IO_URING)
+                IoUring ring;
+                if (ring.setup(std::max(1u, options.queue_depth))) got = ring.read_file(fd, buffer, size, block_size);
+#endif
+                if (got < 0) backend = IoBackend::Pread;
+            }
+
+            if (backend == IoBackend::Pread) {
+#if defined(POSIX_FADV_SEQUENTIAL)
+                posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+                got = read_blocks(fd, buffer, size, 0, block_size);
+            }
+
+            if (got < 0) return false;
+            size = static_cast<size_t>(got);
+            data = buffer;
+            return true;
+        }
+#endif
+    };
+}
+
+}  // namespace fast_io
+
+#endif
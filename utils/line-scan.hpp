@@ -0,0 +1,194 @@
+#ifndef UTILS_LINE_SCAN_HPP
+#define UTILS_LINE_SCAN_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    #define FAST_IO_X86 1
+    #include <immintrin.h>
+#endif
+
+// Target attributes let us compile the AVX2/AVX-512 kernels without -march flags and pick one at runtime.
+// MSVC has no equivalent, so there only the SSE2 kernel (baseline on x64) is used.
+#if defined(FAST_IO_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define FAST_IO_TARGET(isa) __attribute__((target(isa)))
+    #define FAST_IO_HAS_AVX_KERNELS 1
+#else
+    #define FAST_IO_TARGET(isa)
+#endif
+
+//vectorized separator scanning used by fast_io::read_lines / read_delimited.
+namespace fast_io {
+
+enum class SimdLevel : uint8_t {
+    Scalar = 0,
+    SSE2,
+    AVX2,
+    AVX512,
+};
+
+inline const char* to_string(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE2:   return "sse2";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+namespace detail {
+
+    inline SimdLevel detect_simd_level() {
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512bw")) return SimdLevel::AVX512;
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        return SimdLevel::SSE2;
+#elif defined(FAST_IO_X86)
+        return SimdLevel::SSE2;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    inline SimdLevel supported_simd_level() {
+        static const SimdLevel level = detect_simd_level();
+        return level;
+    }
+
+    inline std::atomic<SimdLevel>& active_simd_level() {
+        static std::atomic<SimdLevel> level{supported_simd_level()};
+        return level;
+    }
+
+    // Every kernel reports the position of each byte equal to '\n', '\r' or the delimiter, in order.
+    // Line scanning passes '\n' as the delimiter, which costs one redundant compare.
+    template<typename OnSeparator>
+    inline void scan_separators_scalar(const char* ptr, const char* end, char delimiter, OnSeparator& on_separator) {
+        for (; ptr < end; ++ptr) {
+            if (*ptr == delimiter || *ptr == '\n' || *ptr == '\r') {
+                on_separator(ptr);
+            }
+        }
+    }
+
+    template<typename OnSeparator>
+    inline void emit_mask(const char* block, uint64_t mask, OnSeparator& on_separator) {
+        while (mask) {
+            on_separator(block + std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+    }
+
+#if defined(FAST_IO_X86)
+    FAST_IO_TARGET("sse2")
+    inline uint64_t separator_mask_sse2(const char* p, char delimiter) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                                      _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))),
+                                         _mm_cmpeq_epi8(v, _mm_set1_epi8(delimiter)));
+        return static_cast<uint16_t>(_mm_movemask_epi8(hit));
+    }
+
+    template<typename OnSeparator>
+    FAST_IO_TARGET("sse2")
+    inline void scan_separators_sse2(const char* ptr, const char* end, char delimiter, OnSeparator& on_separator) {
+        while (end - ptr >= 64) {
+            const uint64_t mask = separator_mask_sse2(ptr, delimiter)
+                                | separator_mask_sse2(ptr + 16, delimiter) << 16
+                                | separator_mask_sse2(ptr + 32, delimiter) << 32
+                                | separator_mask_sse2(ptr + 48, delimiter) << 48;
+            emit_mask(ptr, mask, on_separator);
+            ptr += 64;
+        }
+        scan_separators_scalar(ptr, end, delimiter, on_separator);
+    }
+#endif
+
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+    FAST_IO_TARGET("avx2")
+    inline uint64_t separator_mask_avx2(const char* p, char delimiter) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                                                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))),
+                                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8(delimiter)));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+    }
+
+    template<typename OnSeparator>
+    FAST_IO_TARGET("avx2")
+    inline void scan_separators_avx2(const char* ptr, const char* end, char delimiter, OnSeparator& on_separator) {
+        while (end - ptr >= 64) {
+            const uint64_t mask = separator_mask_avx2(ptr, delimiter)
+                                | separator_mask_avx2(ptr + 32, delimiter) << 32;
+            emit_mask(ptr, mask, on_separator);
+            ptr += 64;
+        }
+        scan_separators_scalar(ptr, end, delimiter, on_separator);
+    }
+
+    template<typename OnSeparator>
+    FAST_IO_TARGET("avx512f,avx512bw")
+    inline void scan_separators_avx512(const char* ptr, const char* end, char delimiter, OnSeparator& on_separator) {
+        const __m512i lf = _mm512_set1_epi8('\n');
+        const __m512i cr = _mm512_set1_epi8('\r');
+        const __m512i dl = _mm512_set1_epi8(delimiter);
+
+        while (end - ptr >= 64) {
+            const __m512i v = _mm512_loadu_si512(ptr);
+            const uint64_t mask = _mm512_cmpeq_epi8_mask(v, lf)
+                                | _mm512_cmpeq_epi8_mask(v, cr)
+                                | _mm512_cmpeq_epi8_mask(v, dl);
+            emit_mask(ptr, mask, on_separator);
+            ptr += 64;
+        }
+        scan_separators_scalar(ptr, end, delimiter, on_separator);
+    }
+#endif
+
+    template<typename OnSeparator>
+    inline void scan_separators(const char* ptr, const char* end, char delimiter, OnSeparator&& on_separator) {
+        switch (active_simd_level().load(std::memory_order_relaxed)) {
+#if defined(FAST_IO_HAS_AVX_KERNELS)
+            case SimdLevel::AVX512:
+                scan_separators_avx512(ptr, end, delimiter, on_separator);
+                return;
+            case SimdLevel::AVX2:
+                scan_separators_avx2(ptr, end, delimiter, on_separator);
+                return;
+#endif
+#if defined(FAST_IO_X86)
+            case SimdLevel::SSE2:
+                scan_separators_sse2(ptr, end, delimiter, on_separator);
+                return;
+#endif
+            default:
+                scan_separators_scalar(ptr, end, delimiter, on_separator);
+                return;
+        }
+    }
+}
+
+// Best instruction set supported by this CPU (and this compiler).
+inline SimdLevel supported_simd_level() {
+    return detail::supported_simd_level();
+}
+
+inline SimdLevel simd_level() {
+    return detail::active_simd_level().load(std::memory_order_relaxed);
+}
+
+// Force a lower level, e.g. to benchmark against the scalar path. Requests above what the CPU supports are clamped.
+inline SimdLevel set_simd_level(SimdLevel level) {
+    if (level > supported_simd_level()) level = supported_simd_level();
+    detail::active_simd_level().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+}  // namespace fast_io
+
+#endif
@@ -0,0 +1,76 @@
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+    #include <malloc.h>
+#endif
+
+#include "memory-tracker.hpp"
+
+// Global operator new/delete replacements that feed memory::detail. Only linked in with AOC_TRACK_ALLOCATIONS.
+
+namespace {
+
+    // fallback is the requested size, used where the allocator cannot report the usable one
+    size_t usable_size([[maybe_unused]] void* pointer, [[maybe_unused]] size_t fallback) {
+#if defined(__GLIBC__)
+        return malloc_usable_size(pointer);
+#else
+        return fallback;
+#endif
+    }
+
+    void* allocate(size_t size, size_t alignment) {
+        if (size == 0) size = 1;
+        void* pointer = nullptr;
+        if (alignment <= alignof(std::max_align_t)) {
+            pointer = std::malloc(size);
+        } else {
+            pointer = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        }
+        if (pointer != nullptr) memory::detail::note_allocation(size, usable_size(pointer, size));
+        return pointer;
+    }
+
+    void* allocate_or_throw(size_t size, size_t alignment) {
+        void* pointer = allocate(size, alignment);
+        if (pointer == nullptr) throw std::bad_alloc();
+        return pointer;
+    }
+
+    void release(void* pointer, size_t size) {
+        if (pointer == nullptr) return;
+        memory::detail::note_free(usable_size(pointer, size));
+        std::free(pointer);
+    }
+}
+
+void* operator new(size_t size) { return allocate_or_throw(size, 0); }
+void* operator new[](size_t size) { return allocate_or_throw(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment) {
+    return allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept { release(pointer, 0); }
+void operator delete[](void* pointer) noexcept { release(pointer, 0); }
+void operator delete(void* pointer, size_t size) noexcept { release(pointer, size); }
+void operator delete[](void* pointer, size_t size) noexcept { release(pointer, size); }
+void operator delete(void* pointer, std::align_val_t) noexcept { release(pointer, 0); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { release(pointer, 0); }
+void operator delete(void* pointer, size_t size, std::align_val_t) noexcept { release(pointer, size); }
+void operator delete[](void* pointer, size_t size, std::align_val_t) noexcept { release(pointer, size); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { release(pointer, 0); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { release(pointer, 0); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { release(pointer, 0); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { release(pointer, 0); }
@@ -0,0 +1,108 @@
+#ifndef UTILS_MEMORY_TRACKER_HPP
+#define UTILS_MEMORY_TRACKER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__linux__)
+    #include <sys/resource.h>
+    #include <unistd.h>
+#endif
+
+//heap allocation counters and resident set size. The counters are fed by the global operator new/delete
+//replacements in memory-tracker.cpp, which CMake links in with -DAOC_TRACK_ALLOCATIONS=ON; without them every
+//count stays 0. The RSS readers work either way.
+namespace memory {
+
+struct Snapshot {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;          // as requested from operator new
+    uint64_t reallocations = 0;  // grow-and-free pairs, see note_free
+    uint64_t live_bytes = 0;     // usable size of the blocks not freed yet
+};
+
+constexpr bool tracking() {
+#if defined(AOC_TRACK_ALLOCATIONS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+namespace detail {
+    inline std::atomic<uint64_t> allocations{0};
+    inline std::atomic<uint64_t> bytes{0};
+    inline std::atomic<uint64_t> reallocations{0};
+    inline std::atomic<uint64_t> live_bytes{0};
+    inline std::atomic<uint64_t> peak_live_bytes{0};
+
+    // usable size of this thread's last allocation, 0 once something was freed after it
+    inline thread_local uint64_t last_allocation = 0;
+
+    inline void note_allocation(size_t requested, size_t usable) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(requested, std::memory_order_relaxed);
+        const uint64_t live = live_bytes.fetch_add(usable, std::memory_order_relaxed) + usable;
+        uint64_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        last_allocation = usable;
+    }
+
+    // A smaller block freed right after an allocation on the same thread is what vector/string growth looks
+    // like (allocate, move, free the old buffer), so that pair counts as one reallocation.
+    inline void note_free(size_t usable) {
+        live_bytes.fetch_sub(usable, std::memory_order_relaxed);
+        if (last_allocation > usable && usable > 0) reallocations.fetch_add(1, std::memory_order_relaxed);
+        last_allocation = 0;
+    }
+}
+
+inline Snapshot snapshot() {
+    return {detail::allocations.load(std::memory_order_relaxed), detail::bytes.load(std::memory_order_relaxed),
+            detail::reallocations.load(std::memory_order_relaxed), detail::live_bytes.load(std::memory_order_relaxed)};
+}
+
+// Restarts the live heap high-water mark at the current live size and returns the previous mark. Pass that to
+// end_peak when the phase is over; nested phases then still see their own peaks.
+inline uint64_t begin_peak() {
+    return detail::peak_live_bytes.exchange(detail::live_bytes.load(std::memory_order_relaxed),
+                                            std::memory_order_relaxed);
+}
+
+// Returns the high-water mark since begin_peak and folds it back into the saved outer one.
+inline uint64_t end_peak(uint64_t saved) {
+    const uint64_t peak = detail::peak_live_bytes.load(std::memory_order_relaxed);
+    if (saved > peak) detail::peak_live_bytes.store(saved, std::memory_order_relaxed);
+    return peak;
+}
+
+// Peak resident set size of the process so far (getrusage), 0 where unsupported.
+inline uint64_t peak_rss_kb() {
+#if defined(__linux__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+    return 0;
+}
+
+// Current resident set size from /proc/self/statm, 0 where unsupported.
+inline uint64_t current_rss_kb() {
+#if defined(__linux__)
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (statm == nullptr) return 0;
+    unsigned long long total_pages = 0;
+    unsigned long long resident_pages = 0;
+    const int fields = std::fscanf(statm, "%llu %llu", &total_pages, &resident_pages);
+    std::fclose(statm);
+    if (fields != 2) return 0;
+    return resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) / 1024;
+#else
+    return 0;
+#endif
+}
+
+}  // namespace memory
+
+#endif
@@ -0,0 +1,234 @@
+#ifndef UTILS_PARSE_INT_HPP
+#define UTILS_PARSE_INT_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+//integer parsing for the line/token callbacks, 8 digits per step (SWAR). General purpose.
+namespace fast_io {
+
+enum class ParseError : uint8_t {
+    None = 0,
+    NoDigits,   // nothing that looks like a number at the start
+    Overflow,   // digits do not fit the requested type
+};
+
+template<typename T>
+struct ParseResult {
+    T value{};
+    size_t length = 0;              // bytes consumed: sign and digits
+    ParseError error = ParseError::None;
+
+    explicit operator bool() const { return error == ParseError::None; }
+};
+
+template<typename T>
+struct PairResult {
+    T first{};
+    T second{};
+    size_t length = 0;              // bytes consumed: both numbers and the delimiter
+    ParseError error = ParseError::None;
+
+    explicit operator bool() const { return error == ParseError::None; }
+};
+
+namespace detail {
+
+    constexpr uint64_t BYTES_0x80 = 0x8080808080808080ULL;
+    constexpr uint64_t BYTES_0x7F = 0x7F7F7F7F7F7F7F7FULL;
+
+    constexpr uint64_t POW10[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+    // High bit set in every byte that is not '0'-'9'. The high bits are masked off before adding, so no carry can
+    // cross into the next byte.
+    inline uint64_t non_digit_mask(uint64_t chunk) {
+        const uint64_t high = chunk & BYTES_0x80;
+        const uint64_t low = chunk & BYTES_0x7F;
+        const uint64_t above_nine = low + 0x4646464646464646ULL;    // byte >= 0x3A reaches 0x80
+        const uint64_t below_zero = ~(low + 0x5050505050505050ULL);  // byte < 0x30 stays below 0x80
+        return (high | above_nine | below_zero) & BYTES_0x80;
+    }
+
+    // Value of the first digit_count (1-8) bytes of chunk, first byte most significant. The digits are shifted to
+    // the top so the missing ones read as leading zeros, then pairs, quads and octets are combined with three
+    // multiplies.
+    inline uint64_t swar_digits_value(uint64_t chunk, unsigned digit_count) {
+        uint64_t value = (chunk - 0x3030303030303030ULL) << (8 * (8 - digit_count));
+        value = (value * 10) + (value >> 8);
+        value = (((value & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+                 + (((value >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+        return value;
+    }
+
+    inline uint64_t load_chunk(const char* start) {
+        uint64_t chunk;
+        std::memcpy(&chunk, start, 8);
+        if constexpr (std::endian::native == std::endian::big) chunk = __builtin_bswap64(chunk);
+        return chunk;
+    }
+
+    // value * multiplier + addend; sets overflow when it does not fit. Up to 19 digits cannot overflow, so callers
+    // only come here past that.
+    inline uint64_t scale_checked(uint64_t value, uint64_t multiplier, uint64_t addend, bool& overflow) {
+        const unsigned __int128 scaled = static_cast<unsigned __int128>(value) * multiplier + addend;
+        overflow |= (scaled >> 64) != 0;
+        return static_cast<uint64_t>(scaled);
+    }
+
+    // Adds the leading digits of chunk to value and returns how many there were (0-8).
+    inline unsigned add_chunk_digits(uint64_t chunk, size_t consumed, uint64_t& value, bool& overflow) {
+        constexpr size_t SAFE_DIGITS = 19;  // up to 19 digits cannot overflow a uint64_t
+        const uint64_t stop = non_digit_mask(chunk);
+        const unsigned digit_count = stop == 0 ? 8 : static_cast<unsigned>(std::countr_zero(stop)) / 8;
+        if (digit_count == 0) return 0;
+
+        const uint64_t digits = swar_digits_value(chunk, digit_count);
+        if (consumed + digit_count <= SAFE_DIGITS) value = value * POW10[digit_count] + digits;
+        else value = scale_checked(value, POW10[digit_count], digits, overflow);
+        return digit_count;
+    }
+
+    // Digits only, into a uint64_t. length is the number of digits consumed; on overflow it covers all of them.
+    // Never reads outside [start, end): whole 8-byte chunks while they fit, then the 8 bytes ending at end with the
+    // already consumed ones shifted out. Inputs shorter than 8 bytes go one digit at a time.
+    inline ParseResult<uint64_t> parse_digits_u64(const char* start, const char* end) {
+        ParseResult<uint64_t> result;
+        uint64_t value = 0;
+        const char* p = start;
+        bool overflow = false;
+
+        if (end - start < 8) {
+            for (; p < end && static_cast<unsigned char>(*p - '0') <= 9; ++p) {
+                value = value * 10 + static_cast<uint64_t>(*p - '0');
+            }
+        } else {
+            while (true) {
+                const size_t left = static_cast<size_t>(end - p);
+                if (left == 0) break;
+                const uint64_t chunk = left >= 8 ? load_chunk(p) : load_chunk(end - 8) >> (8 * (8 - left));
+                const unsigned digit_count = add_chunk_digits(chunk, static_cast<size_t>(p - start), value, overflow);
+                p += digit_count;
+                if (digit_count < 8) break;  // the number ended inside this chunk
+            }
+        }
+
+        result.value = value;
+        result.length = static_cast<size_t>(p - start);
+        if (result.length == 0) result.error = ParseError::NoDigits;
+        else if (overflow) result.error = ParseError::Overflow;
+        return result;
+    }
+}
+
+// Parses an integer at the start of [start, end): an optional sign ('-' only for signed types, '+' for any) followed
+// by digits. Stops at the first non-digit; nothing is skipped.
+template<typename IntType = int>
+ParseResult<IntType> parse_number(const char* start, const char* end) {
+    static_assert(std::is_integral_v<IntType>, "parse_number needs an integral type");
+    using Limits = std::numeric_limits<IntType>;
+
+    ParseResult<IntType> result;
+    bool negative = false;
+    size_t sign_length = 0;
+    if (start < end && (*start == '+' || (std::is_signed_v<IntType> && *start == '-'))) {
+        negative = *start == '-';
+        sign_length = 1;
+    }
+
+    const auto digits = detail::parse_digits_u64(start + sign_length, end);
+    if (digits.error == ParseError::NoDigits) {
+        result.error = ParseError::NoDigits;
+        return result;
+    }
+    result.length = sign_length + digits.length;
+
+    uint64_t limit = static_cast<uint64_t>(Limits::max());
+    if (negative) limit += 1;  // |min| of a two's complement type
+    if (digits.error == ParseError::Overflow || digits.value > limit) {
+        result.error = ParseError::Overflow;
+        return result;
+    }
+
+    if constexpr (std::is_signed_v<IntType>) {
+        result.value = negative ? static_cast<IntType>(uint64_t{0} - digits.value) : static_cast<IntType>(digits.value);
+    } else {
+        result.value = static_cast<IntType>(digits.value);
+    }
+    return result;
+}
+
+template<typename IntType = int>
+ParseResult<IntType> parse_number(const char* start, size_t len) {
+    return parse_number<IntType>(start, start + len);
+}
+
+// "<number><delimiter><number>", e.g. a 11-22 range.
+template<typename IntType = int>
+PairResult<IntType> parse_pair(const char* start, size_t len, char delimiter) {
+    const char* end = start + len;
+    PairResult<IntType> result;
+
+    const auto first = parse_number<IntType>(start, end);
+    if (!first) {
+        result.error = first.error;
+        return result;
+    }
+    const char* p = start + first.length;
+    if (p >= end || *p != delimiter) {
+        result.error = ParseError::NoDigits;
+        return result;
+    }
+    ++p;
+
+    const auto second = parse_number<IntType>(p, end);
+    if (!second) {
+        result.error = second.error;
+        return result;
+    }
+
+    result.first = first.value;
+    result.second = second.value;
+    result.length = static_cast<size_t>(p - start) + second.length;
+    return result;
+}
+
+// Numbers separated by delimiter (spaces around them are skipped); on_value(IntType) is called for each one.
+// value is the number count; parsing stops at the first error.
+template<typename IntType = int, typename Consumer>
+ParseResult<size_t> parse_list(const char* start, size_t len, char delimiter, Consumer&& on_value) {
+    const char* end = start + len;
+    const char* p = start;
+    ParseResult<size_t> result;
+
+    const auto skip_spaces = [&] {
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    };
+
+    skip_spaces();
+    while (p < end) {
+        const auto number = parse_number<IntType>(p, end);
+        if (!number) {
+            result.error = number.error;
+            break;
+        }
+        on_value(number.value);
+        ++result.value;
+        p += number.length;
+
+        skip_spaces();
+        if (p >= end || *p != delimiter) break;
+        ++p;
+        skip_spaces();
+    }
+
+    result.length = static_cast<size_t>(p - start);
+    return result;
+}
+
+}  // namespace fast_io
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef UTILS_RECORD_FORMAT_HPP
+#define UTILS_RECORD_FORMAT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "parse-int.hpp"
+
+//compile-time record formats: fast_io::format<"{c}{u32}">.parse(line, len) gives a std::tuple<char, uint32_t>.
+namespace fast_io {
+
+// Fields in a spec:
+//   {c}                 one byte, as char
+//   {s}                 std::string_view up to the next literal in the spec (or the end of the record), zero-copy
+//   {u8} ... {u64}      unsigned integer (fast_io::parse_number)
+//   {i8} ... {i64}      signed integer, optional '-'
+// Anything else is a literal that must match byte for byte; "{{" and "}}" stand for literal braces.
+enum class FieldKind : uint8_t { Literal, Char, String, U8, U16, U32, U64, I8, I16, I32, I64 };
+
+template<size_t N>
+struct FixedString {
+    char chars[N] = {};
+
+    constexpr FixedString(const char (&text)[N]) {
+        for (size_t i = 0; i < N; ++i) chars[i] = text[i];
+    }
+
+    [[nodiscard]] constexpr std::string_view view() const { return {chars, N - 1}; }
+};
+
+namespace detail {
+
+    struct FormatElement {
+        FieldKind kind = FieldKind::Literal;
+        char literal = 0;
+    };
+
+    constexpr FieldKind field_kind(std::string_view name) {
+        if (name == "c") return FieldKind::Char;
+        if (name == "s") return FieldKind::String;
+        if (name == "u8") return FieldKind::U8;
+        if (name == "u16") return FieldKind::U16;
+        if (name == "u32") return FieldKind::U32;
+        if (name == "u64") return FieldKind::U64;
+        if (name == "i8") return FieldKind::I8;
+        if (name == "i16") return FieldKind::I16;
+        if (name == "i32") return FieldKind::I32;
+        if (name == "i64") return FieldKind::I64;
+        throw "unknown field in record format";  // not a constant expression: a compile error at the spec
+    }
+
+    // Calls on_element(FormatElement) for each literal byte and field of the spec, in order.
+    template<typename OnElement>
+    constexpr void walk_spec(std::string_view spec, OnElement&& on_element) {
+        for (size_t i = 0; i < spec.size(); ++i) {
+            const char c = spec[i];
+            if ((c == '{' || c == '}') && i + 1 < spec.size() && spec[i + 1] == c) {
+                on_element(FormatElement{FieldKind::Literal, c});
+                ++i;
+            } else if (c == '{') {
+                const size_t close = spec.find('}', i);
+                if (close == std::string_view::npos) throw "unterminated field in record format";
+                on_element(FormatElement{field_kind(spec.substr(i + 1, close - i - 1)), 0});
+                i = close;
+            } else if (c == '}') {
+                throw "stray '}' in record format";
+            } else {
+                on_element(FormatElement{FieldKind::Literal, c});
+            }
+        }
+    }
+
+    template<FixedString Spec>
+    constexpr size_t element_count() {
+        size_t count = 0;
+        walk_spec(Spec.view(), [&](FormatElement) { ++count; });
+        return count;
+    }
+
+    template<FixedString Spec>
+    constexpr auto elements() {
+        std::array<FormatElement, element_count<Spec>()> result{};
+        size_t i = 0;
+        walk_spec(Spec.view(), [&](FormatElement element) { result[i++] = element; });
+        return result;
+    }
+
+    template<FieldKind Kind> struct field_type;
+    template<> struct field_type<FieldKind::Char> { using type = char; };
+    template<> struct field_type<FieldKind::String> { using type = std::string_view; };
+    template<> struct field_type<FieldKind::U8> { using type = uint8_t; };
+    template<> struct field_type<FieldKind::U16> { using type = uint16_t; };
+    template<> struct field_type<FieldKind::U32> { using type = uint32_t; };
+    template<> struct field_type<FieldKind::U64> { using type = uint64_t; };
+    template<> struct field_type<FieldKind::I8> { using type = int8_t; };
+    template<> struct field_type<FieldKind::I16> { using type = int16_t; };
+    template<> struct field_type<FieldKind::I32> { using type = int32_t; };
+    template<> struct field_type<FieldKind::I64> { using type = int64_t; };
+}
+
+// Parser generated from Spec. Every element is resolved at compile time, so parse() is a straight sequence of
+// literal compares and number parses with the field types baked in.
+template<FixedString Spec>
+struct Format {
+    static constexpr auto ELEMENTS = detail::elements<Spec>();
+
+    // Positions of the fields among the elements.
+    static constexpr auto FIELD_INDICES = [] {
+        constexpr size_t count = [] {
+            size_t n = 0;
+            for (const auto& element : ELEMENTS) n += element.kind != FieldKind::Literal;
+            return n;
+        }();
+        std::array<size_t, count> indices{};
+        size_t field = 0;
+        for (size_t i = 0; i < ELEMENTS.size(); ++i) {
+            if (ELEMENTS[i].kind != FieldKind::Literal) indices[field++] = i;
+        }
+        return indices;
+    }();
+
+    template<size_t... Fields>
+    static auto make_tuple_type(std::index_sequence<Fields...>)
+        -> std::tuple<typename detail::field_type<ELEMENTS[FIELD_INDICES[Fields]].kind>::type...>;
+
+    using Tuple = decltype(make_tuple_type(std::make_index_sequence<FIELD_INDICES.size()>{}));
+
+    // Parses into fields; the whole record has to match, trailing bytes are a mismatch.
+    static bool parse_into(const char* record, size_t len, Tuple& fields) {
+        const char* p = record;
+        const char* end = record + len;
+        return parse_from<0, 0>(p, end, fields) && p == end;
+    }
+
+    // The optional is filled in place: building the tuple and then copying it into the optional makes the copy
+    // read back the fields while their stores are still in flight, which costs more than the parsing.
+    static std::optional<Tuple> parse(const char* record, size_t len) {
+        std::optional<Tuple> fields(std::in_place);
+        if (!parse_into(record, len, *fields)) fields.reset();
+        return fields;
+    }
+
+    // Calls on_record(fields...) if the record matches; returns whether it did.
+    template<typename OnRecord>
+    static bool apply(const char* record, size_t len, OnRecord&& on_record) {
+        Tuple fields{};
+        if (!parse_into(record, len, fields)) return false;
+        std::apply(on_record, fields);
+        return true;
+    }
+
+private:
+    template<size_t Element, size_t Field>
+    static bool parse_from(const char*& p, const char* end, Tuple& fields) {
+        if constexpr (Element == ELEMENTS.size()) {
+            return true;
+        } else {
+            constexpr detail::FormatElement element = ELEMENTS[Element];
+            if constexpr (element.kind == FieldKind::Literal) {
+                if (p == end || *p != element.literal) return false;
+                ++p;
+                return parse_from<Element + 1, Field>(p, end, fields);
+            } else {
+                auto& field = std::get<Field>(fields);
+                if constexpr (element.kind == FieldKind::Char) {
+                    if (p == end) return false;
+                    field = *p++;
+                } else if constexpr (element.kind == FieldKind::String) {
+                    const char* stop = end;
+                    if constexpr (Element + 1 < ELEMENTS.size() && ELEMENTS[Element + 1].kind == FieldKind::Literal) {
+                        stop = p;
+                        while (stop < end && *stop != ELEMENTS[Element + 1].literal) ++stop;
+                    }
+                    field = std::string_view(p, static_cast<size_t>(stop - p));
+                    p = stop;
+                } else {
+                    using Number = std::remove_reference_t<decltype(field)>;
+                    const auto number = parse_number<Number>(p, end);
+                    if (!number) return false;
+                    field = number.value;
+                    p += number.length;
+                }
+                return parse_from<Element + 1, Field + 1>(p, end, fields);
+            }
+        }
+    }
+};
+
+template<FixedString Spec>
+inline constexpr Format<Spec> format{};
+
+}  // namespace fast_io
+
+#endif
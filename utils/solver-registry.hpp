@@ -0,0 +1,46 @@
+#ifndef UTILS_SOLVER_REGISTRY_HPP
+#define UTILS_SOLVER_REGISTRY_HPP
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "batch-runner.hpp"
+
+//days register their parse + solve here so the aoc driver can run them. See N/register.cpp.
+namespace registry {
+
+struct Solver {
+    int day = 0;
+    std::vector<std::string> answer_names;
+    std::function<batch::FileResult(const char* path)> solve_file;  // parse and solve one input, default modes
+};
+
+// Every registered solver, sorted by day once registration is over.
+inline std::vector<Solver>& solvers() {
+    static std::vector<Solver> all;
+    return all;
+}
+
+// Namespace-scope registration object: const registry::Registration DAY{{day, {...}, solve_file}};
+struct Registration {
+    explicit Registration(Solver solver) {
+        auto& all = solvers();
+        const auto position = std::upper_bound(all.begin(), all.end(), solver.day,
+                                               [](int day, const Solver& other) { return day < other.day; });
+        all.insert(position, std::move(solver));
+    }
+};
+
+inline const Solver* find(int day) {
+    for (const Solver& solver : solvers()) {
+        if (solver.day == day) return &solver;
+    }
+    return nullptr;
+}
+
+}  // namespace registry
+
+#endif
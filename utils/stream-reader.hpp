@@ -0,0 +1,225 @@
+#ifndef UTILS_STREAM_READER_HPP
+#define UTILS_STREAM_READER_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+//buffered, non-mmap input for pipes, stdin and anything else that cannot be mapped.
+namespace fast_io {
+
+constexpr size_t STREAM_BUFFER_SIZE = 1024 * 1024;
+
+namespace detail {
+
+    // "-" means standard input.
+    inline bool is_stdin_path(const char* path) {
+        return path[0] == '-' && path[1] == '\0';
+    }
+
+    // Only regular files are mapped; FIFOs, character devices and stdin go through InputStream.
+    inline bool is_mappable(const char* path) {
+        if (is_stdin_path(path)) return false;
+#ifdef _WIN32
+        const DWORD attributes = GetFileAttributesA(path);
+        return attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+        struct stat st;
+        return ::stat(path, &st) == 0 && S_ISREG(st.st_mode);
+#endif
+    }
+
+    struct InputStream {
+#ifdef _WIN32
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        bool owns_handle = false;
+#else
+        int fd = -1;
+        bool owns_fd = false;
+#endif
+
+        bool open(const char* path) {
+#ifdef _WIN32
+            if (is_stdin_path(path)) {
+                handle = GetStdHandle(STD_INPUT_HANDLE);
+                return handle != INVALID_HANDLE_VALUE && handle != nullptr;
+            }
+            handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ,
+                nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            owns_handle = handle != INVALID_HANDLE_VALUE;
+            return owns_handle;
+#else
+            if (is_stdin_path(path)) {
+                fd = STDIN_FILENO;
+                return true;
+            }
+            fd = ::open(path, O_RDONLY);
+            owns_fd = fd >= 0;
+            return owns_fd;
+#endif
+        }
+
+        // Fill as much of the buffer as possible. Returns bytes read (< capacity only at end of input) or -1 on error.
+        long long read(char* buffer, size_t capacity) {
+            size_t filled = 0;
+            while (filled < capacity) {
+#ifdef _WIN32
+                DWORD got = 0;
+                const DWORD want = static_cast<DWORD>(std::min<size_t>(capacity - filled, 1u << 30));
+                if (!ReadFile(handle, buffer + filled, want, &got, nullptr)) {
+                    if (GetLastError() == ERROR_BROKEN_PIPE) break;  // writer closed the pipe
+                    return -1;
+                }
+#else
+                const ssize_t got = ::read(fd, buffer + filled, capacity - filled);
+                if (got < 0) {
+                    if (errno == EINTR) continue;
+                    return -1;
+                }
+#endif
+                if (got == 0) break;
+                filled += static_cast<size_t>(got);
+            }
+            return static_cast<long long>(filled);
+        }
+
+        void close() {
+#ifdef _WIN32
+            if (owns_handle) CloseHandle(handle);
+            handle = INVALID_HANDLE_VALUE;
+            owns_handle = false;
+#else
+            if (owns_fd) ::close(fd);
+            fd = -1;
+            owns_fd = false;
+#endif
+        }
+
+        ~InputStream() { close(); }
+
+        InputStream() = default;
+        InputStream(const InputStream&) = delete;
+        InputStream& operator=(const InputStream&) = delete;
+    };
+
+    // Double-buffered reader: a background thread fills one buffer while the caller parses the other,
+    // so memory use is two buffers regardless of the input size.
+    class StreamReader {
+    public:
+        struct Block {
+            const char* data = nullptr;
+            size_t size = 0;
+        };
+
+        explicit StreamReader(InputStream& input, size_t buffer_size = STREAM_BUFFER_SIZE)
+            : input_(input), buffer_size_(buffer_size) {
+            for (auto& slot : slots_) {
+                slot.data = std::make_unique<char[]>(buffer_size_);
+            }
+            producer_ = std::thread([this] { produce(); });
+        }
+
+        ~StreamReader() {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            changed_.notify_all();
+            producer_.join();
+        }
+
+        StreamReader(const StreamReader&) = delete;
+        StreamReader& operator=(const StreamReader&) = delete;
+
+        // Wait for the next filled block. The block stays valid until release(); returns false at end of input.
+        bool next(Block& block) {
+            Slot& slot = slots_[consumer_index_];
+            std::unique_lock lock(mutex_);
+            changed_.wait(lock, [&] { return slot.filled || slot.last; });
+            if (!slot.filled) return false;
+            block = {slot.data.get(), slot.size};
+            return true;
+        }
+
+        void release() {
+            Slot& slot = slots_[consumer_index_];
+            {
+                std::lock_guard lock(mutex_);
+                slot.filled = false;
+            }
+            changed_.notify_all();
+            consumer_index_ ^= 1;
+        }
+
+        [[nodiscard]] bool failed() const {
+            std::lock_guard lock(mutex_);
+            return failed_;
+        }
+
+    private:
+        struct Slot {
+            std::unique_ptr<char[]> data;
+            size_t size = 0;
+            bool filled = false;
+            bool last = false;  // no block will follow this slot
+        };
+
+        void produce() {
+            for (size_t index = 0;; index ^= 1) {
+                Slot& slot = slots_[index];
+                {
+                    std::unique_lock lock(mutex_);
+                    changed_.wait(lock, [&] { return !slot.filled || stop_; });
+                    if (stop_) return;
+                }
+
+                const long long got = input_.read(slot.data.get(), buffer_size_);
+
+                std::lock_guard lock(mutex_);
+                if (got < 0) failed_ = true;
+                if (got > 0) {
+                    slot.size = static_cast<size_t>(got);
+                    slot.filled = true;
+                }
+                if (got < static_cast<long long>(buffer_size_)) {
+                    // Short read means end of input (or error); mark both slots so the consumer stops after this one.
+                    slots_[index ^ 1].last = true;
+                    if (!slot.filled) slot.last = true;
+                    changed_.notify_all();
+                    return;
+                }
+                changed_.notify_all();
+            }
+        }
+
+        InputStream& input_;
+        size_t buffer_size_;
+        Slot slots_[2];
+        size_t consumer_index_ = 0;
+
+        mutable std::mutex mutex_;
+        std::condition_variable changed_;
+        bool stop_ = false;
+        bool failed_ = false;
+        std::thread producer_;
+    };
+}
+
+}  // namespace fast_io
+
+#endif
@@ -0,0 +1,313 @@
+#ifndef UTILS_THREAD_POOL_HPP
+#define UTILS_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "instrument.hpp"
+
+//fixed size thread pool with a shared FIFO queue, and a work-stealing pool for splittable index ranges
+//(parallel_for / parallel_reduce). General purpose.
+namespace threading {
+
+inline size_t default_thread_count() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+class ThreadPool {
+public:
+    // thread_count 0 = std::thread::hardware_concurrency()
+    explicit ThreadPool(size_t thread_count = 0) {
+        if (thread_count == 0) thread_count = default_thread_count();
+        workers_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i) {
+            workers_.emplace_back([this] {
+                const instrument::CountedThread counted;
+                work();
+            });
+        }
+    }
+
+    // Runs the tasks still queued, then joins.
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        changed_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Tasks start in submission order; they must not throw.
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        changed_.notify_one();
+    }
+
+    // Blocks until the queue is empty and no task is running.
+    void wait_idle() {
+        std::unique_lock lock(mutex_);
+        idle_.wait(lock, [&] { return tasks_.empty() && running_ == 0; });
+    }
+
+    [[nodiscard]] size_t size() const { return workers_.size(); }
+
+private:
+    void work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                changed_.wait(lock, [&] { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty()) return;  // stopping and drained
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+                ++running_;
+            }
+
+            task();
+
+            {
+                std::lock_guard lock(mutex_);
+                --running_;
+                if (running_ == 0 && tasks_.empty()) idle_.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::condition_variable idle_;
+    size_t running_ = 0;
+    bool stop_ = false;
+};
+
+// Work-stealing pool for loops over [first, last) whose items cost very different amounts.
+// A task is a sub-range. The thread running it keeps halving it, pushes the upper halves onto the back of its own
+// deque and runs the lowest grain-sized piece itself. Idle threads steal from the front of the other deques, which
+// is where the biggest halves sit, so a single expensive stretch still ends up spread over every thread.
+// The calling thread takes part in its own loops; with one hardware thread there are no workers and loops run
+// inline. Loops may be started from any thread, also from inside another loop's body.
+class StealingPool {
+public:
+    // thread_count counts the calling thread, so the pool starts thread_count - 1 workers;
+    // 0 = std::thread::hardware_concurrency()
+    explicit StealingPool(size_t thread_count = 0)
+        : queues_(thread_count == 0 ? default_thread_count() : thread_count) {
+        const size_t worker_count = queues_.size() - 1;
+        workers_.reserve(worker_count);
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers_.emplace_back([this, i] {
+                const instrument::CountedThread counted;
+                work(i);
+            });
+        }
+    }
+
+    // Pool shared by parallel_for / parallel_reduce.
+    static StealingPool& instance() {
+        static StealingPool pool(shared_thread_count());
+        return pool;
+    }
+
+    // Threads instance() will use, the caller included; 0 = std::thread::hardware_concurrency(). Only has an
+    // effect before the first instance() call.
+    static void set_shared_thread_count(size_t thread_count) { shared_thread_count() = thread_count; }
+
+    ~StealingPool() {
+        {
+            std::lock_guard lock(sleep_mutex_);
+            stop_ = true;
+        }
+        sleep_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    StealingPool(const StealingPool&) = delete;
+    StealingPool& operator=(const StealingPool&) = delete;
+
+    // Calls body(begin, end) on disjoint sub-ranges covering [first, last), none longer than grain (at least 1).
+    // Returns once all of them are done. body must not throw.
+    template<typename Body>
+    void parallel_for(size_t first, size_t last, size_t grain, Body&& body) {
+        if (first >= last) return;
+        if (workers_.empty() || last - first <= grain) {
+            body(first, last);
+            return;
+        }
+
+        Job job;
+        job.context = const_cast<void*>(static_cast<const void*>(std::addressof(body)));
+        job.run = [](void* context, size_t begin, size_t end) {
+            (*static_cast<std::remove_reference_t<Body>*>(context))(begin, end);
+        };
+        job.grain = std::max<size_t>(1, grain);
+        job.remaining.store(last - first, std::memory_order_relaxed);
+
+        run({&job, first, last});
+        // help with whatever is queued (ours or not) until every item of this loop is done
+        while (job.remaining.load(std::memory_order_acquire) != 0) {
+            Task task;
+            if (take(own_queue(), task)) {
+                run(task);
+                continue;
+            }
+            const uint64_t seen = completions_.load(std::memory_order_acquire);
+            if (job.remaining.load(std::memory_order_acquire) == 0) break;
+            if (queued_.load(std::memory_order_acquire) == 0) completions_.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    // Sum of body(begin, end) over sub-ranges as in parallel_for.
+    template<typename Body>
+    uint64_t parallel_reduce(size_t first, size_t last, size_t grain, Body&& body) {
+        std::atomic<uint64_t> total{0};
+        parallel_for(first, last, grain, [&](size_t begin, size_t end) {
+            total.fetch_add(body(begin, end), std::memory_order_relaxed);
+        });
+        return total.load(std::memory_order_relaxed);
+    }
+
+    // Worker threads, the calling thread not counted.
+    [[nodiscard]] size_t size() const { return workers_.size(); }
+
+private:
+    static size_t& shared_thread_count() {
+        static size_t thread_count = 0;
+        return thread_count;
+    }
+
+    struct Job {
+        void* context = nullptr;
+        void (*run)(void* context, size_t begin, size_t end) = nullptr;
+        size_t grain = 1;
+        std::atomic<size_t> remaining{0};  // items not processed yet
+    };
+
+    struct Task {
+        Job* job = nullptr;
+        size_t first = 0;
+        size_t last = 0;
+    };
+
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // Workers own queues_[0..size()); every other thread shares the last one.
+    size_t own_queue() const {
+        return worker_index_ != NOT_A_WORKER && worker_owner_ == this ? worker_index_ : queues_.size() - 1;
+    }
+
+    void push(const Task& task) {
+        Queue& queue = queues_[own_queue()];
+        {
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(task);
+        }
+        // seq_cst pairs with work(): either the worker sees the task or we see the worker asleep
+        queued_.fetch_add(1);
+        if (sleeping_.load() > 0) {
+            { std::lock_guard lock(sleep_mutex_); }
+            sleep_.notify_one();
+        }
+    }
+
+    // Newest task of our own queue, else the oldest one of the first other queue that has any.
+    bool take(size_t own, Task& task) {
+        for (size_t offset = 0; offset < queues_.size(); ++offset) {
+            Queue& queue = queues_[(own + offset) % queues_.size()];
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            if (offset == 0) {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+            } else {
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+            }
+            queued_.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+        return false;
+    }
+
+    void run(Task task) {
+        Job& job = *task.job;
+        while (task.last - task.first > job.grain) {
+            const size_t middle = task.first + (task.last - task.first) / 2;
+            push({task.job, middle, task.last});
+            task.last = middle;
+        }
+        job.run(job.context, task.first, task.last);
+        // job may be gone as soon as remaining reaches 0, so completions_ is what waiters sleep on
+        job.remaining.fetch_sub(task.last - task.first, std::memory_order_acq_rel);
+        completions_.fetch_add(1, std::memory_order_release);
+        completions_.notify_all();
+    }
+
+    void work(size_t index) {
+        worker_index_ = index;
+        worker_owner_ = this;
+        while (true) {
+            Task task;
+            if (take(index, task)) {
+                run(task);
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex_);
+            sleeping_.fetch_add(1);
+            sleep_.wait(lock, [&] { return stop_ || queued_.load() > 0; });
+            sleeping_.fetch_sub(1, std::memory_order_acq_rel);
+            if (stop_ && queued_.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+
+    static constexpr size_t NOT_A_WORKER = SIZE_MAX;
+    static inline thread_local size_t worker_index_ = NOT_A_WORKER;
+    static inline thread_local const StealingPool* worker_owner_ = nullptr;
+
+    std::vector<Queue> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<uint64_t> completions_{0};
+    std::atomic<size_t> sleeping_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_;
+    bool stop_ = false;
+};
+
+// parallel_for / parallel_reduce on the shared StealingPool.
+template<typename Body>
+void parallel_for(size_t first, size_t last, size_t grain, Body&& body) {
+    StealingPool::instance().parallel_for(first, last, grain, std::forward<Body>(body));
+}
+
+template<typename Body>
+uint64_t parallel_reduce(size_t first, size_t last, size_t grain, Body&& body) {
+    return StealingPool::instance().parallel_reduce(first, last, grain, std::forward<Body>(body));
+}
+
+}  // namespace threading
+
+#endif